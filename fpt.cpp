@@ -1,1215 +1,8751 @@
-/* fpt.cpp
- *
- * This is a unfinished job, waited for 3 years already
- *
- * Program Input:
- *	A configuration file consisting of 6 parameters
- *	1. User specified maximum size of itemset to be mined
- *	   If this value is not larger than zero or 
- *	   is greater than the greatest transaction size in the DB,
- *	   then it will be set to the greatest transaction size.
- *	2. Normalized support threshold, range: (0, 1]
- *	3. Total number of different items in the DB
- *	4. Total number of transactions in the DB
- *	5. Data file name
- *	6. Result file name for storing the large itemsets
- *
- * Program Output: do it later
- *
- */ 
-
-#include<stdio.h>
-#include<stdlib.h>
-#include<string>
-#include<time.h>
-#include<vector>
-#include<sstream>
-#include<iostream>
-#include<math.h>
-#include<map>
-#include<hash_map>
-#include <fstream>
-#include <algorithm>
-using namespace std;
-/***** Data Structure *****/
-/* Description:
- *	Each node of an FP-tree is represented by a 'FPnode' structure.
- *	Each node contains an item ID, count value of the item, and
- *	node-link as stated in the paper.
- *	
- */
-typedef struct FPnode *FPTreeNode;	/* Pointer to a FP-tree node */
-
-typedef struct Childnode *childLink;	/* Pointer to children of a FP-tree node */
-
-/*
- * Children of a FP-tree node
- */
-typedef struct Childnode {
-	FPTreeNode node;	/* A child node of an item */
-	childLink next;		/* Next child */
-} ChildNode;
-
-/*
- * A FP-tree node
- */
-typedef struct FPnode {
-        int item;		/* ID of the item.  
-				   Value of ID is within the range [0, m-1]
-				   where m is the total number of different items in the database. */
-        int count;		/* Value of count of the item.
-				   This is the number of transactions containing items in the portion
-				   of the path reaching this node. */
-	int numPath;  		/* Number of leaf nodes in the subtree
-			           rooted at this node.  It is used to
-				   check whether there is only a single path 
-				   in the FPgrowth function. */
-
-	int numChildren;/*new added: for count of node's childre*/
-
-	FPTreeNode parent;	/* Pointer to parent node */
-        childLink children;	/* Pointer to children */
-        FPTreeNode hlink;	/* Horizontal link to next node with same item */
-} FPNode;
-
-
-/*
- * A list to store large itemsets in descending order of their supports.
- * It stores all the itemsets of supports >= threshold.
- */
-typedef struct Itemsetnode *LargeItemPtr;
-typedef struct Itemsetnode {
-	int support;
-	int *itemset;
-	LargeItemPtr next;
-} ItemsetNode;
-
-/***** Global Variables *****/
-LargeItemPtr *largeItemset;	/* largeItemset[k-1] = array of large k-itemsets */
-int *numLarge;			/* numLarge[k-1] = no. of large k-itemsets found. */
-int *support1;			/* Support of 1-itemsets */
-int *largeItem1;		/* 1-itemsets */
-
-FPTreeNode *headerTableLink;	/* Corresponding header table */
-
-int expectedK;			/* User input upper limit of itemset size to be mined */
-int realK;			/* Actual upper limit of itemset size can be mined */
-int threshold;			/* User input support threshold */
-int numItem;			/* Number of items in the database */
-int numTrans;			/* Number of transactions in the database */
-char dataFile[100];		/* File name of the database */
-char outFile[100];		/* File name to store the result of mining */
-int totalItemInMap = 0;
-string abcd = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz1234567890!@?#$%^&*()_+:>";
-map<string, int> mp;
-map<string, int>::iterator mapit;
-list<FPTreeNode> myList;
-/******************************************************************************************
- * Function: destroyTree
- *
- * Description:
- *	Destroy the FPtree rooted by a node and free the allocated memory.
- *	For each tree node being visited, all the child nodes
- *	are destroyed in a recursive manner before the destroy of the node.
- *
- * Invoked from:	
- * 	destroy()
- * 
- * Input Parameter:
- *	node	-> Root of the tree/subtree to be destroyed.
- */
-void destroyTree(FPTreeNode& node)
-{
- childLink temp1, temp2;
-
- if (node == NULL) return;
-
- temp1 = node->children;
- while(temp1 != NULL) {
-	temp2 = temp1->next;
-	destroyTree(temp1->node);
-	free(temp1);
-	temp1 = temp2;
- }
-
- free(node);
- return;
-}
-
-
-/******************************************************************************************
- * Function: destroy
- *
- * Description:
- *	Free memory of following variables.
- *	- largeItemset
- *	- numLarge
- *	- headerTableLink
- *	- root
- *
- * Invoked from:	
- * 	main()
- * 
- * Functions to be invoked:
- *	destroyTree()	-> Free memory from the FP-tree, root.
- *
- * Global variables (read only):
- *	- realK
- */
-void destroy(FPTreeNode root)
-{
- LargeItemPtr aLargeItemset; 
- int i;
-
- for (i=0; i < realK; i++) {
-	aLargeItemset = largeItemset[i];
-	while (aLargeItemset != NULL) {
-		largeItemset[i] = largeItemset[i]->next;
-		free(aLargeItemset->itemset);
-		free(aLargeItemset);
-		aLargeItemset = largeItemset[i];
-	}
- }
- free(largeItemset);
-
- free(numLarge);
- 
- free(headerTableLink);
-
- destroyTree(root);
-
- return;
-}
-
-
-
-/******************************************************************************************
- * Function: swap
- *
- * Description:
- *	Swap x-th element and i-th element of each of the
- *	two arrays, support[] and itemset[].
- *
- * Invoked from:	
- *	q_sortD()
- *	q_sortA()
- * 
- * Functions to be invoked: None
- *
- * Input Parameters:
- *	support	-> Corresponding supports of the items in itemset.
- *	itemset	-> Array of items.
- *	x, i	-> The two indexes for swapping.
- *
- * Global variable: None
- */
-void swap(int *support, int *itemset, int x, int i)
-{ 
- int temp; 
-
- temp = support[x];
- support[x] = support[i];
- support[i] = temp;
- temp = itemset[x];
- itemset[x] = itemset[i];
- itemset[i] = temp;
- 
- return;
-}
-
-
-/******************************************************************************************
- * Function: q_sortD
- *
- * Description:
- * 	Quick sort two arrays, support[] and the corresponding itemset[], 
- *	in descending order of support[].
- *
- * Invoked from:	
- *	pass1()
- *	genConditionalPatternTree()
- *	q_sortD()
- * 
- * Functions to be invoked:
- *	swap()
- *	q_sortD()
- *
- * Input Parameters:
- *      low		-> lower bound index of the array to be sorted
- *      high		-> upper bound index of the array to be sorted
- *      size		-> size of the array
- *	length		-> length of an itemset
- *
- * In/Out Parameters:
- *      support[]	-> array to be sorted
- *      itemset[]	-> array to be sorted
- */
-void q_sortD(int *support, int *itemset, int low,int high, int size)
-{
- int pass;
- int highptr=high++;     /* highptr records the last element */
- /* the first element in list is always served as the pivot */
- int pivot=low;
-
- if(low>=highptr) return;
- do {
-	/* Find out, from the head of support[], 
-	 * the 1st element value not larger than the pivot's 
-	 */
-	pass=1;
-	while(pass==1) {
-		if(++low<size) {
-			if(support[low] > support[pivot])
-				pass=1;
-			else pass=0;
-		} else pass=0;
-	} 
-
-	/* Find out, from the tail of support[], 
-	 * the 1st element value not smaller than the pivot's 
-	 */ 
-	pass=1; 
-	while(pass==1) {
-		if(high-->0) { 
-			if(support[high] < support[pivot]) 
-				pass=1;
-			else pass=0; 
-		} else pass=0; 
-	}
-
-	/* swap elements pointed by low pointer & high pointer */
-	if(low<high)
-		swap(support, itemset, low, high);
- } while(low<=high);
-
- swap(support, itemset, pivot, high);
-
- /* divide list into two for further sorting */ 
- q_sortD(support, itemset, pivot, high-1, size); 
- q_sortD(support, itemset, high+1, highptr, size);
- 
- return;
-}
-
-
-/******************************************************************************************
- * Function: q_sortA
- *
- * Description:
- * 	Quick sort two arrays, indexList[] and the corresponding freqItemP[], 
- *	in ascending order of indexList[].
- *
- * Invoked from:	
- *	buildTree()
- *	buildConTree()
- *	q_sortA()
- * 
- * Functions to be invoked:
- *	swap()
- *	q_sortA()
- *
- * Input Parameters:
- *      low		-> lower bound index of the array to be sorted
- *      high		-> upper bound index of the array to be sorted
- *      size		-> size of the array
- *	length		-> length of an itemset
- *
- * In/Out Parameters:
- *      indexList[]	-> array to be sorted
- *      freqItemP[]	-> array to be sorted
- */
-void q_sortA(int *indexList, int *freqItemP, int low, int high, int size)
-{
- int pass;
- int highptr=high++;     /* highptr records the last element */
- /* the first element in list is always served as the pivot */
- int pivot=low;
-
- if(low>=highptr) return;
- do {
-        /* Find out, from the head of indexList[], 
-	 * the 1st element value not smaller than the pivot's 
-	 */
-        pass=1;
-        while(pass==1) {
-                if(++low<size) {
-                        if(indexList[low] < indexList[pivot])
-                                pass=1;
-                        else pass=0;
-                } else pass=0;
-        }
-
-        /* Find out, from the tail of indexList[],
-	 * 1st element value not larger than the pivot's 
-	 */
-        pass=1;
-        while(pass==1) {
-                if(high-->0) {
-                        if(indexList[high] > indexList[pivot])
-                                pass=1;
-                        else pass=0;
-                } else pass=0;
-        }
-
-        /* swap elements pointed by low pointer & high pointer */
-        if(low<high)
-                swap(indexList, freqItemP, low, high);
- } while(low<=high);
-
- swap(indexList, freqItemP, pivot, high);
-
- /* divide list into two for further sorting */
- q_sortA(indexList, freqItemP, pivot, high-1, size);
- q_sortA(indexList, freqItemP, high+1, highptr, size);
-
- return;
-}
-
-/******************************************************************************************
- * Function: insert_tree
- *
- * Description:
- *  	This function is to insert a frequent pattern
- *  	of a transaction to the FP-tree (or conditional FP-tree).
- *  	The frequent pattern consists of a list of the frequent 1-items
- *  	of a transaction, and is sorted according to the sorted order of the
- *  		1. frequent 1-items in function pass1(), if it is the initial FP-tree;
- *		2. frequent 1-items in the conditional pattern base, if it is a conditional FP-tree.
- *  	This function is recursively invoked and insert the (ptr+1)th item of the
- *  	frequent pattern in the (ptr+1)th round of recursion.
- *
- *	There are 3 cases to handle the insertion of an item:
- *	1. The tree or subtree being visited has no children.
- *		Create the first child and store the info of the item
- *		to this first child.
- *	2. The tree or subtree has no children that match the current item.
- *		Add a new child node to store the item.
- *	3. There is a match between the item and a child of the tree.
- *		Increment the count of the child, and visit the subtree of this child.
- *
- * Invoked from:	
- *	buildTree()
- *	buildConTree()
- *	insertTree()
- *
- * Functions to be invoked:
- *	insertTree()
- *
- * Parameters:
- *  - freqItemP : The list of frequent items of the transaction.
- *                They are sorted according to the order of frequent 1-items.
- *  - indexList : 'indexList[i]' is the corresponding index of the header table 
- *                that represents the item 'freqItemP[i]'.
- *  - count     : The initial value for the 'count' of the FP-tree node for the current
- *                freqItemP[i].
- *		  It is equal to 1 if the FP-tree is the initial one,
- *		  otherwiese it is equal to the support of the base of 
- *		  this conditional FP-tree.
- *  - ptr       : Number of items in the frequent pattern inserted so far.
- *  - length    : Number of items in the frequent pattern.
- *  - T         : The current FP-tree/subtree being visited so far.
- *  - headerTableLink : Header table of the FP-tree.
- *  - path      : Number of new tree path (i.e. new leaf nodes) created so far for the insertions.
- */
-void insert_tree(int *freqItemP, int *indexList, int count, int ptr, int length, 
-			FPTreeNode T, FPTreeNode *headerTableLink, int *path)  
-{
- childLink newNode;
- FPTreeNode hNode;
- FPTreeNode hPrevious;
- childLink previous;
- childLink aNode;
-
- /* If all the items have been inserted */
- if (ptr == length) return;
-
- /* Case 1 : If the current subtree has no children */
- if (T->children == NULL) {
-	/* T has no children */
-
-	/* Create child nodes for this node */
-	newNode = (childLink) malloc (sizeof(ChildNode));
-	if (newNode == NULL) {
-		printf("out of memory\n");
-		exit(1);
-	}
-
-	/* Create a first child to store the item */
-	newNode->node = (FPTreeNode) malloc (sizeof(FPNode));
-	if (newNode->node == NULL) {
-		printf("out of memory\n");
-		exit(1);
-	}
-
-	/* Store information of the item */
-	newNode->node->item = freqItemP[ptr];
-	newNode->node->count = count;
-	newNode->node->numPath = 1;
-	newNode->node->parent = T;
-	newNode->node->children = NULL;
-	newNode->node->hlink = NULL;
-	newNode->next = NULL;
-	if(newNode->node->parent->numChildren <0)
-		newNode->node->parent->numChildren = 1;
-	else
-		newNode->node->parent->numChildren++;
-	T->children = newNode;
-
-	/* Link the node to the header table */
-	hNode = headerTableLink[indexList[ptr]];
-	if (hNode == NULL) {
-		/* Place the node at the front of the horizontal link for the item */
-		headerTableLink[indexList[ptr]] = newNode->node;
-	} else {
-		/* Place the node at the end using the horizontal link */
-		while (hNode != NULL) {
-			hPrevious = hNode;
-			hNode = hNode->hlink;
-		}
-
-		hPrevious->hlink = newNode->node;
-	}
-
-	/* Insert next item, freqItemP[ptr+1], to the tree */
-	insert_tree(freqItemP, indexList, count, ptr+1, length, T->children->node, headerTableLink, path);
-	T->numPath += *path;
-
- } else {
-	aNode = T->children;
-	while ((aNode != NULL) && (aNode->node->item != freqItemP[ptr])) {
-		previous = aNode;
-		aNode = aNode->next;
-	}
-
-	if (aNode == NULL) {
-		/* Case 2: Create a new child for T */ 
-
-		newNode = (childLink) malloc (sizeof(ChildNode));
-		if (newNode == NULL) {
-			printf("out of memory\n");
-			exit(1);
-		}
-		newNode->node = (FPTreeNode) malloc (sizeof(FPNode));
-		if (newNode->node == NULL) {
-			printf("out of memory\n");
-			exit(1);
-		}
-
-		/* Store information of the item */
-		newNode->node->item = freqItemP[ptr];
-		newNode->node->count = count;
-		newNode->node->numPath = 1;
-		newNode->node->parent = T;
-		newNode->node->children = NULL;
-		newNode->node->hlink = NULL;
-		newNode->next = NULL;
-		if(newNode->node->parent->numChildren <0)
-			newNode->node->parent->numChildren = 1;
-		else
-			newNode->node->parent->numChildren++;
-		previous->next = newNode;
-
-		/* Link the node to the header table */
-		hNode = headerTableLink[indexList[ptr]];
-		if (hNode == NULL) {
-			/* Place the node at the front of the horizontal link for the item */
-			headerTableLink[indexList[ptr]] = newNode->node;
-		} else {
-			/* Place the node at the end using the horizontal link */
-			while (hNode != NULL) {
-				hPrevious = hNode;
-				hNode = hNode->hlink;
-			}
-			hPrevious->hlink = newNode->node;
-		}
-
-		/* Insert next item, freqItemP[ptr+1], to the tree */
-		insert_tree(freqItemP, indexList, count, ptr+1, length, newNode->node, headerTableLink, path);
-
-		(*path)++;
-		T->numPath += *path;
-
-	} else {
-		/* Case 3: Match an existing child of T */
-
-		/* Increment the count */
-		aNode->node->count += count;
-
-		/* Insert next item, freqItemP[ptr+1], to the tree */
-		insert_tree(freqItemP, indexList, count, ptr+1, length, aNode->node, headerTableLink, path);
-
-		T->numPath += *path; 
-	}
- }
-
- return;
-}
-
-/******************************************************************************************
- * Function: pass1()
- *
- * Description:
- *	Scan the DB and find the support of each item.
- *	Find the large 1-itemsets according to the support threshold.
- *
- * Invoked from:	
- *	main()
- *
- * Functions to be invoked:
- *	q_sortD()
- *
- * Global variables:
- *	largeItem1[]	-> Array to store 1-itemsets
- *	support1[]	-> Support[i] = support of the 1-itemset stored in largeItem[i]
- *	largeItemset[]	-> largeItemset[i] = resulting list for large (i+1)-itemsets
- *	realK		-> Maximum size of itemset to be mined
- *	numLarge[]	-> numLarge[i] = Number of large (i+1)-itemsets discovered so far
- *
- * Global variables (read only):
- *	numTrans	-> number of transactions in the database
- *	expectedK	-> User specified maximum size of itemset to be mined
- *	dataFile	-> Database file
- *	
- */
-void pass1()
-{
- int transSize;
- int item;
- int maxSize=0;
- FILE *fp;
- int i, j;
-
- /* Initialize the 1-itemsets list and support list */
- support1 = (int *) malloc (sizeof(int) * numItem);
- largeItem1 = (int *) malloc (sizeof(int) * numItem);
- if ((support1 == NULL) || (largeItem1 == NULL)) {
-	printf("out of memory\n");
-	exit(1);
- }
-
- for (i=0; i < numItem; i++) { 
-	support1[i] = 0;
-	largeItem1[i] = i;
- }
-
- /* scan DB to count the frequency of each item */
-
- if ((fp = fopen(dataFile, "r")) == NULL) {
-        printf("Can't open data file, %s.\n", dataFile);
-        exit(1);
- }
-
- /* Scan each transaction of the DB */
- for (i=0; i < numTrans; i++) {
-
-	/* Read the transaction size */
-	fscanf(fp, "%d", &transSize);
-
-	/* Mark down the largest transaction size found so far */
-	if (transSize > maxSize)
-		maxSize = transSize;
-
-	/* Read the items in the transaction */
-	for (j=0; j < transSize; j++) {
-		fscanf(fp, "%d", &item);
-		support1[item]++;
-	}
- } 
- fclose(fp);
- 
- /* Determine the upper limit of itemset size to be mined according to DB and user input. 
-  * If the user specified maximum itemset size (expectedK) is greater than 
-  * the largest transaction size (maxSize) in the database, or  exptectedK <= 0,
-  * then set  realK = maxSize;
-  * otherwise  realK = expectedK
-  */
- realK = expectedK;
- if ((maxSize < expectedK) || (expectedK <= 0))
-	realK = maxSize;
- printf("max transaction sizes = %d\n", maxSize);
- printf("max itemset size (K_max) to be mined  = %d\n", realK);
-
- /* Initialize large k-itemset resulting list and corresponding support list */
- largeItemset = (LargeItemPtr *) malloc (sizeof(LargeItemPtr) * realK); 
- numLarge = (int *) malloc (sizeof(int) * realK);
-
- if ((largeItemset == NULL) || (numLarge == NULL)) {
-	printf("out of memory\n");
-	exit(1);
- }
-
- for (i=0; i < realK; i++)  {
-	largeItemset[i] = NULL;
-	numLarge[i] = 0;
- }
-
- /* Sort the supports of 1-itemsets in descending order */
- q_sortD(&(support1[0]), largeItem1, 0, numItem-1, numItem);
-
- /*
- for (i=0; i < numItem; i++) 
- 	printf("%d[%d] ", largeItem1[i], support1[i]);
- printf("\n");
- */
-
- numLarge[0] = 0;
- while ((numLarge[0] < numItem) && (support1[numLarge[0]] >= threshold))
-	(numLarge[0])++;
-
- printf("\nNo. of large 1-itemsets (numLarge[0]) = %d\n", numLarge[0]);
-
- return;
-}
-
-
-/******************************************************************************************
- * Function: buildTree()
- *
- * Description:
- *	Build the initial FP-tree.
- *
- * Invoked from:	
- *	main()
- *
- * Functions to be invoked:
- *	insert_tree()
- *	q_sortA()
- *
- * Global variables:
- *	root		-> Pointer to the root of this initial FP-tree
- *	headerTableLink	-> Header table for this initial FP-tree
- *
- * Global variables (read only):
- *	numLarge[]	-> Large k-itemsets resulting list for k = 1 to realK
- */
-void buildTree(FPTreeNode& root)
-{
- int *freqItemP;	/* Store frequent items of a transaction */
- int *indexList;	/* indexList[i] = the index position in the large 1-item list storing freqItemP[i] */
- int count;		/* Number of frequent items in a transaction */
- FILE *fp;		/* Pointer to the database file */
- int transSize;		/* Transaction size */
- int item;		/* An item in the transaction */
- int i, j, m;
- int path;		/* Number of new tree paths (i.e. new leaf nodes) created so far */
-
-
- /* Create header table */
- headerTableLink = (FPTreeNode *) malloc (sizeof(FPTreeNode) * numLarge[0]);
- if (headerTableLink == NULL) {
-	printf("out of memory\n");
-	exit(1);
- }
- for (i=0; i < numLarge[0]; i++)
-	headerTableLink[i] = NULL;
-	
- /* Create root of the FP-tree */
- root = (FPTreeNode) malloc (sizeof(FPNode));
- if (root == NULL) {
-	printf("out of memory\n");
-	exit(1);
- }
-
- /* Initialize the root node */
- root->numPath = 1;
- root->parent = NULL;
- root->children = NULL;
- root->hlink = NULL;
-
- /* Create freqItemP to store frequent items of a transaction */
- freqItemP = (int *) malloc (sizeof(int) * numItem);
- if (freqItemP == NULL) {
-	printf("out of memory\n");
-	exit(1);
- }	
-
- indexList = (int *) malloc (sizeof(int) * numItem);
- if (indexList == NULL) {
-	printf("out of memory\n");
-	exit(1);
- }	
-
-
- /* scan DB and insert frequent items into the FP-tree */
- if ((fp = fopen(dataFile, "r")) == NULL) {
-        printf("Can't open data file, %s.\n", dataFile);
-        exit(1);
- }
-
-
- for (i=0; i < numTrans; i++) {
-
-	/* Read the transaction size */
-	fscanf(fp, "%d", &transSize);
-
-	count = 0;
- 	path = 0;
-
-	for (j=0; j < transSize; j++) {
-
-		/* Read a transaction item */
-		fscanf(fp, "%d", &item);
-
-		/* Store the item to the frequent list, freqItemP, 
-		 * if it is a large 1-item.
-		 */
-		for (m=0; m < numLarge[0]; m++) {
-			if (item == largeItem1[m]) {
-				/* Store the item */
-				freqItemP[count] = item;
-				/* Store the position in the large 1-itemset list storing this item */
-				indexList[count] = m;
-				count++;
-				break;
-			} 
-		}
-	}
-
-	/* Sort the items in the frequent item list in ascending order of indexList,
-	 * i.e. sort according to the order of the large 1-itemset list
-	 */
-	q_sortA(indexList, freqItemP, 0, count-1, count);
-
-	/* Insert the frequent patterns of this transaction to the FP-tree. */
-	insert_tree(&(freqItemP[0]), &(indexList[0]), 1, 0, count, root, headerTableLink, &path);
- } 
- fclose(fp);
-
- free(freqItemP);
- free(indexList);
- free(largeItem1);
- free(support1);
-
- return;
-}
-
-
-/******************************************************************************************
- * Function: input
- *
- * Description:
- *	Read the input parameters from the configuration file.
- *
- * Invoked from:	
- *	main()
- *
- * Functions to be invoked: None
- *
- * Input parameters:
- *	*configFile	-> The configuration file
- *
- * Global variables:
- *	expectedK		-> User specified maximum size of itemset to be mined
- *	thresholdDecimal	-> Normalized support threshold, range: (0, 1]
- *	numItem			-> Total number of different items in the DB
- *	numTrans		-> Total number of transactions in the DB
- *	dataFile		-> Data file
- *	outFile			-> Result file for storing the large itemsets
- */
-void input(char *configFile)
-{
- FILE *fp;
- float thresholdDecimal;
-
- if ((fp = fopen(configFile, "r")) == NULL) {
-        printf("Can't open config. file, %s.\n", configFile);
-        exit(1);
- }
-
- fscanf(fp, "%d %f %d %d", &expectedK, &thresholdDecimal, &numItem, &numTrans);
- fscanf(fp, "%s %s", dataFile, outFile);
- fclose(fp);
-
- printf("expectedK = %d\n", expectedK);
- printf("thresholdDecimal = %f\n", thresholdDecimal);
- printf("numItem = %d\n", numItem);
- printf("numTrans = %d\n", numTrans);
- printf("dataFile = %s\n", dataFile);
- printf("outFile = %s\n\n", outFile);
- threshold = thresholdDecimal * numTrans;
- if (threshold == 0) threshold = 1;
- printf("threshold = %d\n", threshold);
-
- return;
-}
-/******************************************************************************************
- *Function: show_time
- *
- *Description:
- *	will be used later
- *
- */
-void show_time(int i){
-	float time=(float)clock()/CLOCKS_PER_SEC;
-	printf("time %d: %.4f secs.\n", i, time);
-}
-/******************************************************************************************
- *Function: combination(string s) and totalcombs()
- *
- *Description: fastest combination using string
- *	
- */
-int totalcombs(int n, int r){
-	int c=1;
-	if (r > n) return 0;
-	for (int d=1; d <= r; d++) {
-		c *= n--;
-		c /= d;
-	}
-	return c;
-}
-void combination(string alpha, int cc, vector<string> & vstr)
-{
-	//ofstream myfile(filename);
-	//stringstream sout;
-	string s;//string is recycle use, so clear it after use in loops: s.clear();
-	vector<int> indx;
-	int n = alpha.length();
-	int j=1;
-	int k=n;
-	int count = cc;
-	int r;
-	bool done;
-	//hash_map<string,int>::iterator it;
-	for(int twk=j;twk<=k;twk++){
-		r=twk;
-		done=true;
-		for(int iwk=0;iwk<r;iwk++)
-			indx.push_back(iwk);
-		while(done){
-			done=false;
-			for(int owk=0;owk<r;owk++){
-				s.append(1, alpha[indx[owk]]);
-				//myfile<<alpha[indx[owk]];
-			}
-			//myfile<<"\n";
-			totalItemInMap++; 
-			vstr.push_back(s);
-			s.clear();//reuse the string
-			//mp.insert(make_pair<string,int>(s,count));
-				for(int iwk=r-1;iwk>=0;iwk--){
-				if(indx[iwk]<=(n-1)-(r-iwk)){
-					indx[iwk]++;
-					for(int swk=iwk+1;swk<r;swk++){
-						indx[swk]=indx[swk-1]+1;
-					}
-					iwk=-1;
-					done=true;
-				}	
-			}
-		}
-		//myfile << "\n--------------------------- " << endl;
-		//myfile<<sout.str();
-		indx.clear();
-	}
-	//myfile.close();
-}
-/******************************************************************************************
- *Function: combination_node(string s)
- *
- *Description: fastest combination using string
- *	
- */
-void combination_node(FPTreeNode pnode, int cc, map<string, int> & mp)
-{
-	if(cc<1)
-		return;
-	//by node, form a string alpha first
-	string alpha;
-	FPTreeNode t = pnode;
-	while(t->item >0)//from leaf to root into a vector, then combination the vector
-	{
-		alpha.append(1, abcd[t->item]);
-		t->count -= cc;
-		t = t->parent;
-	}
-	//cout<<pnode->item<<" combintation: "<<alpha<<" count: "<<cc<<endl;
-
-
-	string s;//string is recycle use, so clear it after use in loops: s.clear();
-	vector<int> indx;
-	int n = alpha.length();
-	int j=1;
-	int k=n;
-	int count = cc;
-	int r;
-	bool done;
-	for(int twk=j;twk<=k;twk++){
-		r=twk;
-		done=true;
-		for(int iwk=0;iwk<r;iwk++)
-			indx.push_back(iwk);
-		while(done){
-			done=false;
-			for(int owk=0;owk<r;owk++){
-				s.append(1, alpha[indx[owk]]);
-				//myfile<<alpha[indx[owk]];
-			}
-			//insert into map:
-			if((mapit = mp.find(s)) == mp.end())
-			{
-				mp.insert(make_pair(s,cc));
-			}
-			else
-			{
-				mapit->second += cc;
-			}
-			
-			totalItemInMap++; 
-
-			s.clear();//reuse the string
-				for(int iwk=r-1;iwk>=0;iwk--){
-				if(indx[iwk]<=(n-1)-(r-iwk)){
-					indx[iwk]++;
-					for(int swk=iwk+1;swk<r;swk++){
-						indx[swk]=indx[swk-1]+1;
-					}
-					iwk=-1;
-					done=true;
-				}	
-			}
-		}
-		indx.clear();
-	}
-}
-/******************************************************************************************
- *Function: test_tree()
- *
- *Description:
- *	
- */
-void test_tree(FPTreeNode pnode){ // this is to find all the branches based on leaf-nodes
-	childLink link = pnode->children;
-	while(link){ //depth first
-
-		test_tree(link->node);//depth first recursive
-		link = link->next;
-		}
-}
-/******************************************************************************************
- *Function: loop_same_items()
- *
- *Description: loop down-top to do combination
- *Data Structure used: headerTableLink[]
- *
- */
-void loop_same_items()
-{
-	int size = numLarge[0];
-	//array of vector string
-	vector<string> *vstr = new vector<string>[numLarge[0]];
-	for(int i =0;i<size;i++)
-	{
-		//////do the pruning first, using map and count
-		FPTreeNode p = headerTableLink[i];//p is used to access the same name item link
-		//create a file here
-		map<char, int> mpcount;
-		//std::string filename;
-		//std::stringstream out;
-		//out << i;
-		//filename = out.str();
-		while(p)//for each same name item, go from down to top to access parents and form a string for combination
-		{
-			FPTreeNode t = p->parent;// t is used to access parents nodes
-			int pcount = p->count;
-			while(t->item >0)//!!!make it larger than 0, means escape root, because root's item is a minus number
-			{
-				char name = abcd[t->item];
-				//s.append(1,abcd[t->item]);
-				if(mpcount.find(name) != mpcount.end())//found, then update count
-				{
-					mpcount[name] += pcount;
-				}
-				else //not found
-				{
-					mpcount.insert(make_pair(name, pcount));
-				}
-				t = t->parent;
-			}
-		}
-			/*combination(s, 1,vstr[i]);
-			sort(vstr[i].begin(), vstr[i].end());*/
-			//:store the string in a vector, then combination
-			//cout<<abcd[p->item]<<"--->"<<s<<endl;
-			//s.clear();
-			/////////////////////////////////////////////////////////////////////////////do the combination
-		p = headerTableLink[i];//p is used to access the same name item link
-		string s;
-		while(p)//for each same name item, go from down to top to access parents and form a string for combination
-		{
-			FPTreeNode t = p->parent;// t is used to access parents nodesb
-			while(t->item >0)//!!!make it larger than 0, means escape root, because root's item is a minus number
-			{
-				if(mpcount[abcd[t->item]] >= threshold)//
-				{
-					s.append(1,abcd[t->item]);
-				}
-				t = t->parent;
-			}
-			combination(s, 1, vstr[i]);
-			sort(vstr[i].begin(), vstr[i].end());
-			/////////////////////////////////////////////////////////////////////////////
-			vstr[i].clear();
-			p = p->hlink;
-		}
-		mpcount.clear();
-	}//for loop end
-}
-/******************************************************************************************
- * Function: vect_ini(FPTreeNode p)
- *
- * Description: initial all the nodes
- */
-void vect_ini(FPTreeNode p)
-{
-	childLink link = p->children;
-	if(link){
-		while(link)
-		{
-			//access the node from here: link->node
-			vect_ini(link->node);
-			link = link->next;
-		}
-	}
-	else //find the leaf nodes
-	{
-		FPTreeNode t = p;//t is for leaf node use only
-		int cc = t->count;
-		string str;
-
-		FPTreeNode s = t;//s is for leaf combination use only
-		combination_node(s,s->count,mp);
-
-		while(t->item >0)//from leaf to root into a vector, then combination the vector
-		{
-			//str.append(1, abcd[t->item]);
-			FPTreeNode r = t;
-
-			if(r->count < r->parent->count)//the branch number is larger
-			{
-				combination_node(r->parent,r->parent->count,mp);
-			}
-			//cout<<"---------"<<r->item<<" count: "<<r->count<<endl;
-
-
-			t = t->parent;
-		}
-		//combination(str, cc);
-		//cout<<endl;
-	}
-}
-/******************************************************************************************
- * Function: init_list(FPTreeNode p)
- *
- * Description: initial the leaf nodes
- */
-void init_list(FPTreeNode p)
-{
-	childLink link = p->children;
-	if(link){
-		while(link)
-		{
-			//access the node from here: link->node
-			init_list(link->node);
-			link = link->next;
-		}
-	}
-	else //find the leaf nodes
-	{
-		myList.push_back(p);
-	}
-}
-/******************************************************************************************
- * Function: traverse_list(FPTreeNode p)
- *
- * Description: initial all the nodes
- */
-void traverse_list(list<FPTreeNode> & myList, FPTreeNode & root)
-{
-	list<FPTreeNode>::iterator lit;
-	for (lit = myList.begin(); lit != myList.end(); lit++ )
-	{
-		if((*lit)->parent != root)
-		{
-		if((*lit)->parent->numChildren == 1)
-			myList.push_back((*lit)->parent);
-		else
-			(*lit)->parent->numChildren--;
-		}
-		//combination here
-		combination_node(*lit, (*lit)->count, mp);
-		//cout<<(*lit)->item<<endl;
-		
-	}
-}
-/******************************************************************************************
- * Function: main
- *
- * Description:
- *	This function reads the config. file for six input parameters,
- *	finds the frequent 1-itemsets, builds the initial FP-tree 
- *	using the frequent 1-itemsets and 
- *	peforms the FP-growth algorithm of the paper.
- *	It measure both CPU and I/O time for build tree and mining.
- *
- * Functions to be invoked: 
- *	input()		-> Read config. file
- *	pass1()		-> Scan DB and find frquent 1-itemsets
- *	buildTree()	-> Build the initial FP-tree
- *	FPgrowth()	-> Start mining
- *	
- * Parameters:
- *	Config. file name
- */
-void main(int argc, char *argv[])
-{
- //float time1, time2, time3;
- int headerTableSize;
- int totaloverlap=0;
- FPTreeNode root=NULL;		/* Initial FP-tree */
-
- /* Usage ------------------------------------------*/
- printf("\nFP-tree: Mining large itemsets using user support threshold\n\n");
- if (argc != 2) {
-        printf("Usage: %s <config. file>\n\n", argv[0]);
-	printf("Content of config. file:\n");
-	printf("  Line 1: Upper limit of large itemsets size to be mined\n");
-	printf("  Line 2: Support threshold (normalized to [0, 1])\n");
-	printf("  Line 3: No. of different items in the DB\n");
-	printf("  Line 4: No. of transactions in the DB\n");
-	printf("  Line 5: File name of the DB\n");
-	printf("  Line 6: Result file name to store the large itemsets\n\n");
-        exit(1);
- }
-
- /* read input parameters --------------------------*/
- printf("input\n");
- input(argv[1]);
- /* pass 1 : Mine the large 1-itemsets -------------*/
- printf("\npass1\n");
- pass1();
- /* Mine the large k-itemsets (k = 2 to realK) -----*/
- if (numLarge[0] > 0) {
-	/* create FP-tree --------------------------*/
- 	printf("\nbuildTree\n");
-	show_time(1);
- 	buildTree(root);
-	show_time(2);
-	/*<--------------------------------------start from here--------------------------------------->*/
-	show_time(3);
-
-	init_list(root);
-	traverse_list(myList, root);
-	//vect_ini(root);
-	//for(mapit = mp.begin();mapit != mp.end();mapit++)
-	//{
-	//	cout<<mapit->first<<" : "<<mapit->second<<endl;
-	//}
-	show_time(4);
-	//cout<<"total: "<<totalItemInMap<<endl;
-	///////////////////////////
- }
- destroy(root);
- return;
-}
-
+/* fpt.cpp
+ *
+ * This is a unfinished job, waited for 3 years already
+ *
+ * Program Input:
+ *	A configuration file consisting of 6 parameters
+ *	1. User specified maximum size of itemset to be mined
+ *	   If this value is not larger than zero or 
+ *	   is greater than the greatest transaction size in the DB,
+ *	   then it will be set to the greatest transaction size.
+ *	2. Normalized support threshold, range: (0, 1]
+ *	3. Total number of different items in the DB
+ *	4. Total number of transactions in the DB
+ *	5. Data file name
+ *	6. Result file name for storing the large itemsets
+ *	Optional "<name> <value>" lines may follow, see setOption().
+ *
+ * Program Output:
+ *	The large itemsets in the result file, one per line:
+ *		<item> <item> ... (<support>)
+ *	and, if a rule file is given, the association rules in the rule file:
+ *		<item> ... => <item> ... (<support>, <confidence>, <lift>)
+ *
+ * Library use:
+ *	Compiled with -DFPT_LIBRARY, main() is left out and the miner is
+ *	used through the FPConfig/FPMiner API of fpt.h.
+ *
+ * Compressed data files:
+ *	Compiled with -DHAVE_ZLIB (link -lz) and/or -DHAVE_ZSTD (link -lzstd),
+ *	a gzip or zstd compressed data file is read as it is, see openReader().
+ *
+ */ 
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<limits.h>
+#include<string.h>
+#include<string>
+#include<time.h>
+#include<vector>
+#include<sstream>
+#include<iostream>
+#include<math.h>
+#include<map>
+#include<hash_map>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <queue>
+#include <random>
+#include <memory>
+#include <stdarg.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#endif
+#ifdef _WIN32
+#define strtok_r strtok_s	/* The reentrant strtok() of the MS C runtime */
+#endif
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TOKENIZE_SIMD		/* The SIMD tokenizers, chosen at run time */
+#define KERNEL_SIMD		/* The SIMD bitset and tid-list kernels, chosen at run time */
+#endif
+#if defined(TOKENIZE_SIMD) || defined(KERNEL_SIMD)
+#include <immintrin.h>
+#endif
+#include "fpt.h"
+using namespace std;
+/***** Global Variables *****/
+const char *engineName[NUM_ENGINE] = {"auto", "fptree", "bitset", "eclat", "declat", "fpgrowth", "patricia"};
+const char *tokenizerName[NUM_TOKENIZE] = {"auto", "scalar", "sse4", "avx2"};
+const char *pagesName[NUM_PAGES] = {"small", "transparent huge", "explicit huge"};
+
+#define BITSET_RATIO	64		/* Bitsets are used if numItem * BITSET_RATIO <= numTrans */
+#define BITSET_MAX_BYTES (1 << 30)	/* and the bitsets fit in 1GB */
+#define MAX_SPILL_FILES	32	/* Max. number of partitions of a DB spilled to disk at a time */
+#define SIM_CACHE_LINES	4096	/* Lines of 64 bytes of the cache simulated by the counters */
+#define QUERY_LINE	65536	/* Max. length of a query line, newline included */
+#define INFLATE_BLOCK	(1 << 17)	/* Bytes of a block of a compressed DB decompressed at a time */
+#define READ_BLOCK	(1 << 16)	/* Bytes of the text of the DB read at a time */
+#define HUGE_PAGE	(1 << 21)	/* Bytes of a huge page */
+#define NUMA_MAX_NODES	64	/* Max. number of NUMA nodes used */
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED	1	/* Memory policy of set_mempolicy(), from <numaif.h> */
+#endif
+
+#ifdef __GNUC__
+#define PREFETCH(addr)	__builtin_prefetch(addr)
+#else
+#define PREFETCH(addr)
+#endif
+
+#ifdef __linux__
+static int thp = 0;	/* Transparent huge pages are enabled, set once by probeThp() */
+
+/*
+ * Read the THP policy of the system into thp; run once per process, see bigAlloc().
+ */
+static void probeThp()
+{
+ char line[64];
+ FILE *fp;
+
+ if ((fp = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r")) != NULL) {
+	if ((fgets(line, sizeof(line), fp) != NULL) && (strstr(line, "[never]") == NULL))
+		thp = 1;
+	fclose(fp);
+ }
+ return;
+}
+#endif
+/******************************************************************************************
+ * Function: bigAlloc
+ *
+ * Description:
+ *	Allocate a big block of zeroed memory, on huge pages if the policy
+ *	lets it and the system has them: explicit huge pages of the hugetlbfs
+ *	pool first (HUGE_AUTO), then anonymous memory aligned to a huge page
+ *	and advised to transparent huge pages, otherwise calloc().
+ *	A block smaller than a huge page is calloc()'ed.  The pages are not
+ *	touched here, so they go to the NUMA node of the thread writing them first.
+ *
+ * Invoked from:	
+ *	relayoutTree()
+ *	buildBitsets()
+ *	buildTidLists()
+ *	openReader(), nextTrans()
+ *	buildTree(), growBatch()
+ *
+ * Functions to be invoked:
+ *	probeThp()
+ *
+ * Input parameters:
+ *	bytes	-> Size of the block
+ *	policy	-> HUGE_xxx
+ *
+ * Output parameter:
+ *	block	-> The block, base NULL if out of memory
+ *
+ * Return:
+ *	The base of the block.
+ */
+static void *bigAlloc(BigBlock *block, size_t bytes, int policy)
+{
+#ifdef __linux__
+ static once_flag probed;	/* Several miners may run in one process */
+ size_t size;
+ char *p, *q;
+
+ if ((policy != HUGE_OFF) && (bytes >= HUGE_PAGE)) {
+	size = (bytes + HUGE_PAGE - 1) & ~((size_t) HUGE_PAGE - 1);
+	if (policy == HUGE_AUTO) {
+		p = (char *) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (p != MAP_FAILED) {
+			block->base = p;
+			block->bytes = size;
+			block->pages = PAGES_HUGETLB;
+			return p;
+		}
+	}
+	call_once(probed, probeThp);
+#ifdef MADV_HUGEPAGE
+	/* Map a huge page more and trim the ends, for a base on a huge page */
+	if ((thp) && ((p = (char *) mmap(NULL, size + HUGE_PAGE, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) != MAP_FAILED)) {
+		q = (char *) (((size_t) p + HUGE_PAGE - 1) & ~((size_t) HUGE_PAGE - 1));
+		if (q > p)
+			munmap(p, q - p);
+		munmap(q + size, (p + size + HUGE_PAGE) - (q + size));
+		if (madvise(q, size, MADV_HUGEPAGE) == 0) {
+			block->base = q;
+			block->bytes = size;
+			block->pages = PAGES_THP;
+			return q;
+		}
+		munmap(q, size);
+	}
+#endif
+ }
+#endif
+ block->base = calloc(bytes, 1);
+ block->bytes = bytes;
+ block->pages = PAGES_SMALL;
+ return block->base;
+}
+/******************************************************************************************
+ * Function: bigFree
+ *
+ * Description:
+ *	Free a block of bigAlloc(), if any.
+ *
+ * Invoked from:	
+ *	relayoutTree()
+ *	destroy()
+ *	nextTrans(), releaseReader()
+ *	growBatch(), ~Transring()
+ *
+ * Functions to be invoked: None
+ *
+ * Input/output parameter:
+ *	block	-> The block, base set to NULL
+ */
+static void bigFree(BigBlock *block)
+{
+ if (block->base == NULL)
+	return;
+#ifdef __linux__
+ if (block->pages != PAGES_SMALL)
+	munmap(block->base, block->bytes);
+ else
+#endif
+	free(block->base);
+ block->base = NULL;
+}
+/******************************************************************************************
+ * Function: numaNodes
+ *
+ * Description:
+ *	Find the NUMA nodes of the system and their CPUs, from
+ *	/sys/devices/system/node/node<n>/cpulist ("0-3,8-11").
+ *
+ * Invoked from:	
+ *	build()
+ *	mineShards()
+ *
+ * Functions to be invoked: None
+ *
+ * Output parameter:
+ *	cpus	-> cpus[n] = the CPUs of node n
+ *
+ * Return:
+ *	The number of nodes, 1 if they are not known.
+ */
+#ifdef __linux__
+static int numaNodes(vector<cpu_set_t> &cpus)
+{
+ char name[64], list[4096];
+ char *p;
+ FILE *fp;
+ int lo, hi, c, n;
+
+ cpus.clear();
+ for (n=0; n < NUMA_MAX_NODES; n++) {
+	sprintf(name, "/sys/devices/system/node/node%d/cpulist", n);
+	if ((fp = fopen(name, "r")) == NULL)
+		break;
+	cpus.resize(n + 1);
+	CPU_ZERO(&cpus[n]);
+	if (fgets(list, sizeof(list), fp) != NULL) {
+		for (p = list; sscanf(p, "%d", &lo) == 1; ) {
+			hi = lo;
+			p += strspn(p, "0123456789");
+			if (*p == '-')
+				hi = (int) strtol(p + 1, &p, 10);
+			for (c = lo; (c <= hi) && (c < CPU_SETSIZE); c++)
+				CPU_SET(c, &cpus[n]);
+			if (*p != ',')
+				break;
+			p++;
+		}
+	}
+	fclose(fp);
+ }
+ return (n > 0) ? n : 1;
+}
+/******************************************************************************************
+ * Function: numaBind
+ *
+ * Description:
+ *	Bind the calling thread to the CPUs of a NUMA node, and make the node
+ *	the preferred one of the memory it allocates from now on.  Threads
+ *	created by it are bound alike.
+ *
+ * Invoked from:	
+ *	workShard(), in a worker process of mineShards()
+ *
+ * Functions to be invoked: None
+ *
+ * Input parameters:
+ *	node	-> The node
+ *	cpus	-> Its CPUs
+ */
+static void numaBind(int node, const cpu_set_t *cpus)
+{
+ unsigned long mask = 1UL << node;
+
+ sched_setaffinity(0, sizeof(cpu_set_t), cpus);
+ syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, sizeof(mask) * 8 + 1);
+}
+#endif
+/******************************************************************************************
+ * Function: destroyTree
+ *
+ * Description:
+ *	Destroy the FPtree rooted by a node and free the allocated memory.
+ *	For each tree node being visited, all the child nodes
+ *	are destroyed in a recursive manner before the destroy of the node.
+ *
+ * Invoked from:	
+ * 	destroy()
+ * 
+ * Input Parameter:
+ *	node	-> Root of the tree/subtree to be destroyed.
+ */
+static void destroyTree(FPTreeNode& node)
+{
+ childLink temp1, temp2;
+
+ if (node == NULL) return;
+
+ temp1 = node->children;
+ while(temp1 != NULL) {
+	temp2 = temp1->next;
+	destroyTree(temp1->node);
+	free(temp1);
+	temp1 = temp2;
+ }
+
+ free(node);
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: destroyPatTree
+ *
+ * Description:
+ *	Free the memory of a Patricia FP-tree, children before their parent.
+ *
+ * Invoked from:	
+ * 	destroy()
+ *	patGrowth()
+ * 
+ * Input Parameter:
+ *	node	-> Root of the tree/subtree to be destroyed.
+ */
+static void destroyPatTree(PatTreeNode node)
+{
+ PatTreeNode child, next;
+
+ if (node == NULL) return;
+
+ for (child = node->children; child != NULL; child = next) {
+	next = child->sibling;
+	destroyPatTree(child);
+ }
+ free(node);
+ return;
+}
+
+
+#ifndef _WIN32
+extern char **environ;
+#endif
+
+/*
+ * The fpt program, run as the shard workers of mineShards(); set by main(),
+ * NULL when fpt.cpp is compiled as a library.
+ */
+static const char *shardProgram = NULL;
+
+/*
+ * Owners of the local trees and temporary files of the mining engines:
+ * destroyed, or closed, as they go out of scope, so that an FPError
+ * thrown in the middle of the mining leaks nothing.
+ */
+struct TreeDeleter {
+	void operator()(FPTreeNode root) const { destroyTree(root); }
+	void operator()(PatTreeNode root) const { destroyPatTree(root); }
+};
+typedef unique_ptr<FPNode, TreeDeleter> TreeOwner;
+typedef unique_ptr<PatNode, TreeDeleter> PatTreeOwner;
+
+struct FileCloser {
+	void operator()(FILE *fp) const { fclose(fp); }
+};
+typedef unique_ptr<FILE, FileCloser> FileOwner;
+
+
+/******************************************************************************************
+ * Function: hashItemId
+ *
+ * Description:
+ *	Hash of an item ID (the finalizer of MurmurHash3).
+ */
+static inline unsigned int hashItemId(long long id)
+{
+ unsigned long long h = (unsigned long long) id;
+
+ h ^= h >> 33;
+ h *= 0xff51afd7ed558ccdULL;
+ h ^= h >> 33;
+ h *= 0xc4ceb9fe1a85ec53ULL;
+ h ^= h >> 33;
+ return (unsigned int) h;
+}
+/******************************************************************************************
+ * Function: initDict
+ *
+ * Description:
+ *	Create an empty item dictionary.
+ */
+static void initDict(ItemDict *dict)
+{
+ dict->numKeys = 0;
+ dict->sizeKeys = 512;
+ dict->size = 1024;
+ dict->key = (long long *) malloc (sizeof(long long) * dict->sizeKeys);
+ dict->slot = (int *) malloc (sizeof(int) * dict->size);
+ if ((dict->key == NULL) || (dict->slot == NULL)) {
+	throw FPError("out of memory");
+ }
+ memset(dict->slot, -1, sizeof(int) * dict->size);
+ return;
+}
+/******************************************************************************************
+ * Function: rehashDict
+ *
+ * Description:
+ *	Rebuild the slots of an item dictionary with the given number of slots.
+ */
+static void rehashDict(ItemDict *dict, int size)
+{
+ unsigned int h;
+ int i;
+
+ free(dict->slot);
+ dict->size = size;
+ dict->slot = (int *) malloc (sizeof(int) * size);
+ if (dict->slot == NULL) {
+	throw FPError("out of memory");
+ }
+ memset(dict->slot, -1, sizeof(int) * size);
+ for (i=0; i < dict->numKeys; i++) {
+	h = hashItemId(dict->key[i]) & (size - 1);
+	while (dict->slot[h] >= 0)
+		h = (h + 1) & (size - 1);
+	dict->slot[h] = i;
+ }
+ return;
+}
+/******************************************************************************************
+ * Function: lookupDict
+ *
+ * Description:
+ *	Find the dense item of an item ID, adding the ID if it is new and insert is set.
+ *
+ * Return:
+ *	The dense item, or -1 if the ID is not in the dictionary.
+ */
+static int lookupDict(ItemDict *dict, long long id, int insert)
+{
+ unsigned int h;
+ int d;
+
+ h = hashItemId(id) & (dict->size - 1);
+ while ((d = dict->slot[h]) >= 0) {
+	if (dict->key[d] == id)
+		return d;
+	h = (h + 1) & (dict->size - 1);
+ }
+ if (!insert)
+	return -1;
+
+ if (dict->numKeys == dict->sizeKeys) {
+	dict->sizeKeys *= 2;
+	dict->key = (long long *) realloc (dict->key, sizeof(long long) * dict->sizeKeys);
+	if (dict->key == NULL) {
+		throw FPError("out of memory");
+	}
+ }
+ d = dict->numKeys++;
+ dict->key[d] = id;
+ dict->slot[h] = d;
+ if (dict->numKeys * 2 > dict->size)
+	rehashDict(dict, dict->size * 2);
+ return d;
+}
+/******************************************************************************************
+ * Function: sortDict
+ *
+ * Description:
+ *	Renumber the dense items in ascending order of item ID, so the
+ *	order of the dense items is the order of the item IDs.
+ *
+ * Output parameter:
+ *	perm	-> perm[old] = new dense item
+ */
+static void sortDict(ItemDict *dict, int *perm)
+{
+ vector<pair<long long, int> > order(dict->numKeys);
+ int i;
+
+ for (i=0; i < dict->numKeys; i++)
+	order[i] = make_pair(dict->key[i], i);
+ sort(order.begin(), order.end());
+ for (i=0; i < dict->numKeys; i++) {
+	dict->key[i] = order[i].first;
+	perm[order[i].second] = i;
+ }
+ rehashDict(dict, dict->size);
+ return;
+}
+/******************************************************************************************
+ * Function: freeDict
+ *
+ * Description:
+ *	Free the memory of an item dictionary.
+ */
+static void freeDict(ItemDict *dict)
+{
+ free(dict->key);
+ free(dict->slot);
+ dict->key = NULL;
+ dict->slot = NULL;
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: destroy
+ *
+ * Description:
+ *	Free memory of following variables.
+ *	- largeItemset
+ *	- itemsetIndex
+ *	- numLarge
+ *	- largeItem1, support1, itemRank
+ *	- tidBits, tidLists
+ *	- condBase
+ *	- sampleTrans, sampleLen
+ *	- ckptLog, ckptMark
+ *	- itemFlag, itemPrice
+ *	- simTag
+ *	- headerTableLink
+ *	- root, or nodeArena and childArena
+ *	- patHeader, patRoot
+ *	- dict
+ *
+ * Invoked from:	
+ * 	~FPMiner()
+ * 
+ * Functions to be invoked:
+ *	destroyTree()	-> Free memory from the FP-tree, root.
+ *
+ * Member variables (read only):
+ *	- realK
+ */
+void FPMiner::destroy()
+{
+ LargeItemPtr aLargeItemset; 
+ int i;
+
+ for (i=0; (largeItemset != NULL) && (i < realK); i++) {
+	aLargeItemset = largeItemset[i];
+	while (aLargeItemset != NULL) {
+		largeItemset[i] = largeItemset[i]->next;
+		free(aLargeItemset->itemset);
+		free(aLargeItemset);
+		aLargeItemset = largeItemset[i];
+	}
+ }
+ free(largeItemset);
+ delete[] itemRuns;
+
+ if (itemsetIndex != NULL) {
+	for (i=0; i < realK; i++)
+		free(itemsetIndex[i].slot);
+	free(itemsetIndex);
+ }
+
+ free(tidLists);
+ bigFree(&tidBlock);
+
+ free(numLarge);
+ free(largeItem1);
+ free(support1);
+ free(itemRank);
+ bigFree(&bitBlock);
+ for (i=0; i < numSample; i++)
+	free(sampleTrans[i]);
+ free(sampleTrans);
+ free(sampleLen);
+ if (ckptLog != NULL)
+	fclose(ckptLog);
+ free(ckptMark);
+ free(itemFlag);
+ free(itemPrice);
+ free(simTag);
+ free(condBase.support);
+ free(condBase.ranks);
+ free(condBase.pathLen);
+ free(condBase.pathCount);
+ 
+ free(headerTableLink);
+ freeDict(&dict);
+ free(patHeader);
+ destroyPatTree(patRoot);
+
+ if (nodeArena != NULL) {
+	bigFree(&nodeBlock);
+	bigFree(&childBlock);
+ } else
+	destroyTree(root);
+
+ return;
+}
+
+
+
+/******************************************************************************************
+ * Function: swap
+ *
+ * Description:
+ *	Swap x-th element and i-th element of each of the
+ *	two arrays, support[] and itemset[].
+ *
+ * Invoked from:	
+ *	q_sortD()
+ *	q_sortA()
+ * 
+ * Functions to be invoked: None
+ *
+ * Input Parameters:
+ *	support	-> Corresponding supports of the items in itemset.
+ *	itemset	-> Array of items.
+ *	x, i	-> The two indexes for swapping.
+ *
+ * Global variable: None
+ */
+static void swap(int *support, int *itemset, int x, int i)
+{ 
+ int temp; 
+
+ temp = support[x];
+ support[x] = support[i];
+ support[i] = temp;
+ temp = itemset[x];
+ itemset[x] = itemset[i];
+ itemset[i] = temp;
+ 
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: q_sortD
+ *
+ * Description:
+ * 	Quick sort two arrays, support[] and the corresponding itemset[], 
+ *	in descending order of support[].
+ *
+ * Invoked from:	
+ *	pass1()
+ *	genConditionalPatternTree()
+ *	q_sortD()
+ * 
+ * Functions to be invoked:
+ *	swap()
+ *	q_sortD()
+ *
+ * Input Parameters:
+ *      low		-> lower bound index of the array to be sorted
+ *      high		-> upper bound index of the array to be sorted
+ *      size		-> size of the array
+ *	length		-> length of an itemset
+ *
+ * In/Out Parameters:
+ *      support[]	-> array to be sorted
+ *      itemset[]	-> array to be sorted
+ */
+static void q_sortD(int *support, int *itemset, int low,int high, int size)
+{
+ int pass;
+ int highptr=high++;     /* highptr records the last element */
+ /* the first element in list is always served as the pivot */
+ int pivot=low;
+
+ if(low>=highptr) return;
+ do {
+	/* Find out, from the head of support[], 
+	 * the 1st element value not larger than the pivot's 
+	 */
+	pass=1;
+	while(pass==1) {
+		if(++low<size) {
+			if(support[low] > support[pivot])
+				pass=1;
+			else pass=0;
+		} else pass=0;
+	} 
+
+	/* Find out, from the tail of support[], 
+	 * the 1st element value not smaller than the pivot's 
+	 */ 
+	pass=1; 
+	while(pass==1) {
+		if(high-->0) { 
+			if(support[high] < support[pivot]) 
+				pass=1;
+			else pass=0; 
+		} else pass=0; 
+	}
+
+	/* swap elements pointed by low pointer & high pointer */
+	if(low<high)
+		swap(support, itemset, low, high);
+ } while(low<=high);
+
+ swap(support, itemset, pivot, high);
+
+ /* divide list into two for further sorting */ 
+ q_sortD(support, itemset, pivot, high-1, size); 
+ q_sortD(support, itemset, high+1, highptr, size);
+ 
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: q_sortA
+ *
+ * Description:
+ * 	Quick sort two arrays, indexList[] and the corresponding freqItemP[], 
+ *	in ascending order of indexList[].
+ *
+ * Invoked from:	
+ *	buildTree()
+ *	buildConTree()
+ *	q_sortA()
+ * 
+ * Functions to be invoked:
+ *	swap()
+ *	q_sortA()
+ *
+ * Input Parameters:
+ *      low		-> lower bound index of the array to be sorted
+ *      high		-> upper bound index of the array to be sorted
+ *      size		-> size of the array
+ *	length		-> length of an itemset
+ *
+ * In/Out Parameters:
+ *      indexList[]	-> array to be sorted
+ *      freqItemP[]	-> array to be sorted
+ */
+static void q_sortA(int *indexList, int *freqItemP, int low, int high, int size)
+{
+ int pass;
+ int highptr=high++;     /* highptr records the last element */
+ /* the first element in list is always served as the pivot */
+ int pivot=low;
+
+ if(low>=highptr) return;
+ do {
+        /* Find out, from the head of indexList[], 
+	 * the 1st element value not smaller than the pivot's 
+	 */
+        pass=1;
+        while(pass==1) {
+                if(++low<size) {
+                        if(indexList[low] < indexList[pivot])
+                                pass=1;
+                        else pass=0;
+                } else pass=0;
+        }
+
+        /* Find out, from the tail of indexList[],
+	 * 1st element value not larger than the pivot's 
+	 */
+        pass=1;
+        while(pass==1) {
+                if(high-->0) {
+                        if(indexList[high] > indexList[pivot])
+                                pass=1;
+                        else pass=0;
+                } else pass=0;
+        }
+
+        /* swap elements pointed by low pointer & high pointer */
+        if(low<high)
+                swap(indexList, freqItemP, low, high);
+ } while(low<=high);
+
+ swap(indexList, freqItemP, pivot, high);
+
+ /* divide list into two for further sorting */
+ q_sortA(indexList, freqItemP, pivot, high-1, size);
+ q_sortA(indexList, freqItemP, high+1, highptr, size);
+
+ return;
+}
+
+/******************************************************************************************
+ * Function: newTreeNode
+ *
+ * Description:
+ *	Allocate a new FP-tree node together with its entry in the children list.
+ *	The memory of the tree is accounted in treeBytes; if the node would
+ *	exceed the memory budget, or memory runs out, treeOverflow is set instead.
+ *	The node gets the next node index of the tree.
+ *
+ * Invoked from:	
+ *	insert_tree()
+ *
+ * Member variables:
+ *	treeBytes	-> Memory used by the FP-tree being built
+ *	treeOverflow	-> Set if the FP-tree does not fit
+ *	numNodes	-> Number of nodes of the FP-tree
+ *
+ * Return:
+ *	The new children entry with its node, or NULL if the tree does not fit.
+ */
+childLink FPMiner::newTreeNode()
+{
+ childLink newNode;
+
+ if ((config.memBudget > 0) && (treeBytes + (long) (sizeof(ChildNode) + sizeof(FPNode)) > config.memBudget)) {
+	treeOverflow = 1;
+	return NULL;
+ }
+
+ newNode = (childLink) malloc (sizeof(ChildNode));
+ if (newNode == NULL) {
+	treeOverflow = 1;
+	return NULL;
+ }
+ newNode->node = (FPTreeNode) malloc (sizeof(FPNode));
+ if (newNode->node == NULL) {
+	free(newNode);
+	treeOverflow = 1;
+	return NULL;
+ }
+
+ treeBytes += sizeof(ChildNode) + sizeof(FPNode);
+ newNode->node->id = numNodes++;
+ return newNode;
+}
+
+/******************************************************************************************
+ * Function: insert_tree
+ *
+ * Description:
+ *  	This function is to insert a frequent pattern
+ *  	of a transaction to the FP-tree (or conditional FP-tree).
+ *  	The frequent pattern consists of a list of the frequent 1-items
+ *  	of a transaction, and is sorted according to the sorted order of the
+ *  		1. frequent 1-items in function pass1(), if it is the initial FP-tree;
+ *		2. frequent 1-items in the conditional pattern base, if it is a conditional FP-tree.
+ *  	This function is recursively invoked and insert the (ptr+1)th item of the
+ *  	frequent pattern in the (ptr+1)th round of recursion.
+ *
+ *	There are 3 cases to handle the insertion of an item:
+ *	1. The tree or subtree being visited has no children.
+ *		Create the first child and store the info of the item
+ *		to this first child.
+ *	2. The tree or subtree has no children that match the current item.
+ *		Add a new child node to store the item.
+ *	3. There is a match between the item and a child of the tree.
+ *		Increment the count of the child, and visit the subtree of this child.
+ *
+ *	If a new node would exceed the memory budget, treeOverflow is set
+ *	and the insertion stops; the caller has to give up the tree.
+ *
+ * Invoked from:	
+ *	buildTree()
+ *	buildConTree()
+ *	insertTree()
+ *
+ * Functions to be invoked:
+ *	newTreeNode()
+ *	insertTree()
+ *
+ * Parameters:
+ *  - freqItemP : The list of frequent items of the transaction.
+ *                They are sorted according to the order of frequent 1-items.
+ *  - indexList : 'indexList[i]' is the corresponding index of the header table 
+ *                that represents the item 'freqItemP[i]'.
+ *  - count     : The initial value for the 'count' of the FP-tree node for the current
+ *                freqItemP[i].
+ *		  It is equal to 1 if the FP-tree is the initial one,
+ *		  otherwiese it is equal to the support of the base of 
+ *		  this conditional FP-tree.
+ *  - ptr       : Number of items in the frequent pattern inserted so far.
+ *  - length    : Number of items in the frequent pattern.
+ *  - T         : The current FP-tree/subtree being visited so far.
+ *  - headerTableLink : Header table of the FP-tree.
+ *  - path      : Number of new tree path (i.e. new leaf nodes) created so far for the insertions.
+ */
+void FPMiner::insert_tree(int *freqItemP, int *indexList, int count, int ptr, int length, 
+			FPTreeNode T, FPTreeNode *headerTableLink, int *path)  
+{
+ childLink newNode;
+ childLink previous;
+ childLink aNode;
+
+ /* If all the items have been inserted */
+ if (ptr == length) return;
+
+ /* Case 1 : If the current subtree has no children */
+ if (T->children == NULL) {
+	/* T has no children */
+
+	/* Create a first child to store the item */
+	if ((newNode = newTreeNode()) == NULL)
+		return;
+
+	/* Store information of the item */
+	newNode->node->item = freqItemP[ptr];
+	newNode->node->count = count;
+	newNode->node->numPath = 1;
+	newNode->node->parent = T;
+	newNode->node->children = NULL;
+	newNode->node->hlink = NULL;
+	newNode->node->numChildren = 0;
+	newNode->next = NULL;
+	if(newNode->node->parent->numChildren <0)
+		newNode->node->parent->numChildren = 1;
+	else
+		newNode->node->parent->numChildren++;
+	T->children = newNode;
+
+	/* Link the node to the header table, at the front of the horizontal link for the item */
+	newNode->node->hlink = headerTableLink[indexList[ptr]];
+	headerTableLink[indexList[ptr]] = newNode->node;
+
+	/* Insert next item, freqItemP[ptr+1], to the tree */
+	insert_tree(freqItemP, indexList, count, ptr+1, length, T->children->node, headerTableLink, path);
+	T->numPath += *path;
+
+ } else {
+	aNode = T->children;
+	while ((aNode != NULL) && (aNode->node->item != freqItemP[ptr])) {
+		previous = aNode;
+		aNode = aNode->next;
+	}
+
+	if (aNode == NULL) {
+		/* Case 2: Create a new child for T */ 
+
+		if ((newNode = newTreeNode()) == NULL)
+			return;
+
+		/* Store information of the item */
+		newNode->node->item = freqItemP[ptr];
+		newNode->node->count = count;
+		newNode->node->numPath = 1;
+		newNode->node->parent = T;
+		newNode->node->children = NULL;
+		newNode->node->hlink = NULL;
+		newNode->node->numChildren = 0;
+		newNode->next = NULL;
+		if(newNode->node->parent->numChildren <0)
+			newNode->node->parent->numChildren = 1;
+		else
+			newNode->node->parent->numChildren++;
+		previous->next = newNode;
+
+		/* Link the node to the header table, at the front of the horizontal link for the item */
+		newNode->node->hlink = headerTableLink[indexList[ptr]];
+		headerTableLink[indexList[ptr]] = newNode->node;
+
+		/* Insert next item, freqItemP[ptr+1], to the tree */
+		insert_tree(freqItemP, indexList, count, ptr+1, length, newNode->node, headerTableLink, path);
+
+		(*path)++;
+		T->numPath += *path;
+
+	} else {
+		/* Case 3: Match an existing child of T */
+
+		/* Increment the count */
+		aNode->node->count += count;
+
+		/* Insert next item, freqItemP[ptr+1], to the tree */
+		insert_tree(freqItemP, indexList, count, ptr+1, length, aNode->node, headerTableLink, path);
+
+		T->numPath += *path; 
+	}
+ }
+
+ return;
+}
+
+/******************************************************************************************
+ * Function: readSome
+ *
+ * Description:
+ *	Read what is there of the next n bytes of a file, at least one byte
+ *	unless at the end, so a stream is parsed as it comes.
+ *
+ * Return:
+ *	Number of bytes read, 0 at the end of the file (or on an error).
+ */
+static int readSome(FILE *fp, char *p, int n)
+{
+#ifdef _WIN32
+ return fread(p, 1, n, fp);
+#else
+ ssize_t got;
+
+ while (((got = read(fileno(fp), p, n)) < 0) && (errno == EINTR))
+	;
+ return (got > 0) ? got : 0;
+#endif
+}
+/******************************************************************************************
+ * Function: scanTokens
+ *
+ * Description:
+ *	The scalar tokenizer: cut text into integers, "[+-]<digits>" separated
+ *	by blanks, as fscanf("%lld") reads them.  The SIMD tokenizers give the
+ *	same tokens, byte for byte, and leave to this one what they do not take.
+ *	Unless the text is final, an integer reaching the end of the text may
+ *	go on in the next block, and is left for it.
+ *
+ * Invoked from:	
+ *	fillTokens()
+ *	scanTokensSSE4(), scanTokensAVX2()
+ *
+ * Input parameters:
+ *	p, end		-> The text
+ *	final		-> No more text follows
+ *	maxTokens	-> Room in tokens[]
+ *
+ * Output parameters:
+ *	tokens	-> The integers
+ *	used	-> Bytes of the text cut into tokens
+ *	bad	-> Set if the text stops at a byte that is no integer
+ *
+ * Return:
+ *	Number of tokens.
+ */
+static inline int isDelim(unsigned char c)
+{
+ return (c == ' ') || ((c >= '\t') && (c <= '\r'));
+}
+
+static int scanTokens(const char *p, const char *end, int final, long long *tokens, int maxTokens, int *used, int *bad)
+{
+ const char *begin = p, *start;
+ unsigned long long v;
+ int neg, n = 0;
+
+ *bad = 0;
+ while (n < maxTokens) {
+	while ((p < end) && (isDelim(*p)))
+		p++;
+	if (p == end)
+		break;
+	start = p;
+	neg = (*p == '-');
+	if ((*p == '-') || (*p == '+'))
+		p++;
+	if ((p == end) && (!final)) {
+		p = start;
+		break;
+	}
+	if ((p == end) || ((unsigned char) (*p - '0') > 9)) {
+		p = start;
+		*bad = 1;
+		break;
+	}
+	for (v = 0; (p < end) && ((unsigned char) (*p - '0') <= 9); p++)
+		v = v * 10 + (*p - '0');
+	if ((p == end) && (!final)) {
+		p = start;
+		break;
+	}
+	tokens[n++] = (neg) ? -(long long) v : (long long) v;
+ }
+
+ *used = p - begin;
+ return n;
+}
+#ifdef TOKENIZE_SIMD
+/******************************************************************************************
+ * Function: convertDigits
+ *
+ * Description:
+ *	The value of len (1 to 16) decimal digits at the front of a vector, less '0'
+ *	each: the digits are moved to the back of the vector by one pshufb, and
+ *	pairs, quads and octets of them are summed by multiply-adds.
+ */
+static const unsigned char alignDigits[32] = {
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+};
+
+__attribute__((target("sse4.1")))
+static inline long long convertDigits(__m128i d, int len)
+{
+ d = _mm_shuffle_epi8(d, _mm_loadu_si128((const __m128i *) (alignDigits + len)));
+ d = _mm_maddubs_epi16(d, _mm_set_epi8(1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10));
+ d = _mm_madd_epi16(d, _mm_set_epi16(1, 100, 1, 100, 1, 100, 1, 100));
+ d = _mm_packus_epi32(d, d);
+ d = _mm_madd_epi16(d, _mm_set_epi16(1, 10000, 1, 10000, 1, 10000, 1, 10000));
+ return (long long) _mm_cvtsi128_si32(d) * 100000000 + _mm_extract_epi32(d, 1);
+}
+/******************************************************************************************
+ * Function: scanTokensSSE4
+ *
+ * Description:
+ *	The SSE4.1 tokenizer, see scanTokens(): the digits of an integer are
+ *	found by one compare of the 16 bytes at its start, and converted by
+ *	convertDigits().  Signs, longer integers and the last 16 bytes of the
+ *	text are left to scanTokens().
+ */
+__attribute__((target("sse4.1")))
+static int scanTokensSSE4(const char *p, const char *end, int final, long long *tokens, int maxTokens, int *used, int *bad)
+{
+ const char *begin = p;
+ __m128i d;
+ int digit, len, m, u;
+ int n = 0;
+
+ *bad = 0;
+ while ((n < maxTokens) && (p + 16 <= end)) {
+	if (isDelim(*p)) {
+		p++;
+		continue;
+	}
+	d = _mm_sub_epi8(_mm_loadu_si128((const __m128i *) p), _mm_set1_epi8('0'));
+	digit = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d));
+	len = __builtin_ctz(~digit);
+	if ((len == 0) || (len == 16)) {
+		m = scanTokens(p, end, final, tokens + n, 1, &u, bad);
+		n += m;
+		p += u;
+		if (m == 0)
+			break;
+		continue;
+	}
+	tokens[n++] = convertDigits(d, len);
+	p += len;
+ }
+ if ((!*bad) && (n < maxTokens)) {
+	n += scanTokens(p, end, final, tokens + n, maxTokens - n, &u, bad);
+	p += u;
+ }
+
+ *used = p - begin;
+ return n;
+}
+/******************************************************************************************
+ * Function: scanTokensAVX2
+ *
+ * Description:
+ *	The AVX2 tokenizer, see scanTokens(): the digits and the delimiters of
+ *	a window of 32 bytes are found by two compares, and each run of digits
+ *	ending in the window is converted by convertDigits().  The window then
+ *	moves past the last of them.  What the window cannot take (signs, bad
+ *	bytes, longer integers) is left to scanTokens(), and the last 48 bytes
+ *	of the text to scanTokensSSE4().
+ */
+__attribute__((target("avx2")))
+static int scanTokensAVX2(const char *p, const char *end, int final, long long *tokens, int maxTokens, int *used, int *bad)
+{
+ const char *begin = p;
+ __m256i v, d, t;
+ unsigned long long digit, delim, starts;
+ int limit, adv, o, len, m, u;
+ int n = 0;
+
+ *bad = 0;
+ while ((n + 32 <= maxTokens) && (p + 48 <= end)) {
+	v = _mm256_loadu_si256((const __m256i *) p);
+	d = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+	digit = (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d));
+	t = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+	delim = (unsigned int) _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(4)), t),
+								    _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '))));
+
+	/* Runs of digits starting before the first byte that is neither */
+	limit = __builtin_ctzll(~(digit | delim));
+	starts = digit & ~(digit << 1) & ((1ULL << limit) - 1);
+	adv = limit;
+	while (starts != 0) {
+		o = __builtin_ctzll(starts);
+		len = __builtin_ctzll(~(digit >> o));
+		if ((o + len >= 32) || (len > 16)) {
+			adv = o;
+			break;
+		}
+		tokens[n++] = convertDigits(_mm_sub_epi8(_mm_loadu_si128((const __m128i *) (p + o)), _mm_set1_epi8('0')), len);
+		adv = o + len;
+		starts &= starts - 1;
+	}
+	if (adv == 0) {
+		m = scanTokens(p, end, final, tokens + n, 1, &u, bad);
+		n += m;
+		p += u;
+		if (m == 0)
+			break;
+		continue;
+	}
+	p += adv;
+ }
+ if ((!*bad) && (n < maxTokens)) {
+	n += scanTokensSSE4(p, end, final, tokens + n, maxTokens - n, &u, bad);
+	p += u;
+ }
+
+ *used = p - begin;
+ return n;
+}
+#endif
+/******************************************************************************************
+ * Function: chooseTokenizer
+ *
+ * Description:
+ *	The tokenizer of a reader: the one asked for, or the fastest the CPU has
+ *	if it does not have that one (or none is asked for).
+ */
+typedef int (*Tokenizer)(const char *p, const char *end, int final, long long *tokens, int maxTokens, int *used, int *bad);
+#ifdef TOKENIZE_SIMD
+static const Tokenizer tokenizers[NUM_TOKENIZE] = {scanTokens, scanTokens, scanTokensSSE4, scanTokensAVX2};
+#else
+static const Tokenizer tokenizers[NUM_TOKENIZE] = {scanTokens, scanTokens, scanTokens, scanTokens};
+#endif
+
+static int chooseTokenizer(int want)
+{
+ int best = TOKENIZE_SCALAR;
+
+#ifdef TOKENIZE_SIMD
+ __builtin_cpu_init();
+ if (__builtin_cpu_supports("avx2"))
+	best = TOKENIZE_AVX2;
+ else if (__builtin_cpu_supports("sse4.1"))
+	best = TOKENIZE_SSE4;
+#endif
+ return ((want == TOKENIZE_AUTO) || (want > best)) ? best : want;
+}
+/******************************************************************************************
+ * Function: fillTokens
+ *
+ * Description:
+ *	Read the next block of the text of the DB and cut it into tokens;
+ *	an integer cut by the end of the block is kept for the next one.
+ *
+ * Invoked from:	
+ *	nextTrans()
+ *
+ * Functions to be invoked:
+ *	readSome()
+ *	scanTokens(), scanTokensSSE4() or scanTokensAVX2()
+ *
+ * Return:
+ *	1, or 0 if there are no more tokens.
+ */
+static int fillTokens(TransReader *reader)
+{
+ int tail, got, used, bad;
+
+ while (!reader->atEnd) {
+	tail = reader->bufLen - reader->bufPos;
+	memmove(reader->buf, reader->buf + reader->bufPos, tail);
+	got = (tail < READ_BLOCK) ? readSome(reader->fp, reader->buf + tail, READ_BLOCK - tail) : 0;
+	reader->bufLen = tail + got;
+	reader->numTokens = tokenizers[reader->tokenizer](reader->buf, reader->buf + reader->bufLen, (got == 0),
+							  reader->tokens, READ_BLOCK / 2 + 1, &used, &bad);
+	reader->bufPos = used;
+	reader->tokenPos = 0;
+	if ((bad) || (got == 0))
+		reader->atEnd = 1;
+	if (reader->numTokens > 0)
+		return 1;
+ }
+
+ return 0;
+}
+#if defined(HAVE_ZLIB) || defined(HAVE_ZSTD)
+/******************************************************************************************
+ * Function: writeAll
+ *
+ * Description:
+ *	Write n bytes to the pipe of an inflater.
+ *
+ * Return:
+ *	1, or 0 if the reader has closed the pipe.
+ */
+static int writeAll(int out, const unsigned char *p, size_t n)
+{
+ ssize_t done;
+
+ while (n > 0) {
+	if ((done = write(out, p, n)) < 0) {
+		if (errno == EINTR)
+			continue;
+		return 0;
+	}
+	p += done;
+	n -= done;
+ }
+ return 1;
+}
+
+/******************************************************************************************
+ * Function: inflateStage
+ *
+ * Description:
+ *	The inflater thread of a reader of a compressed DB: decompress the
+ *	file into the pipe the transactions are parsed from, so the DB is never
+ *	decompressed to disk, and the parser works while the next block is
+ *	being decompressed.  The magic bytes, already read by openReader(),
+ *	come first.  The pipe is closed at the end; if the reader closes it
+ *	first, the thread just stops.  An error is left in reader->error.
+ *
+ * Invoked from:	
+ *	openReader(), as a thread
+ *
+ * Input parameters:
+ *	reader	-> The reader, with its compressed file in reader->src
+ *	format	-> DATA_GZIP or DATA_ZSTD
+ *	magic	-> The magic bytes read
+ *	out	-> Write end of the pipe
+ */
+static void inflateStage(TransReader *reader, int format, string magic, int out)
+{
+ vector<unsigned char> in(INFLATE_BLOCK), buf(INFLATE_BLOCK);
+ size_t n = magic.size();
+ int more = 1;
+ sigset_t mask;
+
+ /* A write to the pipe closed by the reader fails instead of raising SIGPIPE */
+ sigemptyset(&mask);
+ sigaddset(&mask, SIGPIPE);
+ pthread_sigmask(SIG_BLOCK, &mask, NULL);
+ memcpy(&in[0], magic.data(), n);
+
+#ifdef HAVE_ZLIB
+ if (format == DATA_GZIP) {
+	z_stream zs;
+	int ret, ended = 0;	/* ended: the last gzip member is complete */
+
+	memset(&zs, 0, sizeof(zs));
+	if (inflateInit2(&zs, 15 + 32) != Z_OK) {	/* 32: gzip header */
+		strcpy(reader->error, "out of memory");
+		more = 0;
+	}
+	while (more) {
+		n += fread(&in[n], 1, INFLATE_BLOCK - n, reader->src);
+		if (n == 0)
+			break;
+		zs.next_in = &in[0];
+		zs.avail_in = n;
+		do {
+			zs.next_out = &buf[0];
+			zs.avail_out = INFLATE_BLOCK;
+			ret = inflate(&zs, Z_NO_FLUSH);
+			if (ret == Z_BUF_ERROR)
+				break;		/* Nothing more before the next block */
+			if ((ret != Z_OK) && (ret != Z_STREAM_END)) {
+				snprintf(reader->error, sizeof(reader->error), "corrupt gzip data (%s)", (zs.msg != NULL) ? zs.msg : "?");
+				more = 0;
+			} else if (!writeAll(out, &buf[0], INFLATE_BLOCK - zs.avail_out))
+				more = 0;
+			else if ((ended = (ret == Z_STREAM_END)))
+				inflateReset(&zs);	/* Another gzip member may follow */
+		} while (more && ((zs.avail_in > 0) || (zs.avail_out == 0)));
+		n = 0;
+	}
+	if ((more) && (!ended))
+		strcpy(reader->error, "truncated gzip data");
+	inflateEnd(&zs);
+ }
+#endif
+#ifdef HAVE_ZSTD
+ if (format == DATA_ZSTD) {
+	ZSTD_DStream *zs = ZSTD_createDStream();
+	ZSTD_inBuffer zin;
+	ZSTD_outBuffer zout;
+	size_t ret = 0;		/* 0: the last frame is complete */
+
+	if (zs == NULL) {
+		strcpy(reader->error, "out of memory");
+		more = 0;
+	}
+	while (more) {
+		n += fread(&in[n], 1, INFLATE_BLOCK - n, reader->src);
+		if (n == 0)
+			break;
+		zin.src = &in[0];
+		zin.size = n;
+		zin.pos = 0;
+		do {
+			zout.dst = &buf[0];
+			zout.size = INFLATE_BLOCK;
+			zout.pos = 0;
+			ret = ZSTD_decompressStream(zs, &zout, &zin);
+			if (ZSTD_isError(ret)) {
+				snprintf(reader->error, sizeof(reader->error), "corrupt zstd data (%s)", ZSTD_getErrorName(ret));
+				more = 0;
+			} else if (!writeAll(out, &buf[0], zout.pos))
+				more = 0;
+		} while (more && ((zin.pos < zin.size) || (zout.pos == zout.size)));
+		n = 0;
+	}
+	if ((more) && (ret != 0))
+		strcpy(reader->error, "truncated zstd data");
+	ZSTD_freeDStream(zs);
+ }
+#endif
+ close(out);
+
+ return;
+}
+#endif
+/******************************************************************************************
+ * Function: openReader
+ *
+ * Description:
+ *	Open the database file for a scan of its transactions.
+ *	Every scan of the DB (pass1(), buildTree() and the other mining engines)
+ *	reads the transactions through a TransReader.
+ *	A gzip or zstd compressed DB, told by its magic bytes, is decompressed
+ *	on the fly by an inflater thread (inflateStage()) into a pipe, which the
+ *	transactions are read from.  Each scan decompresses the file again.
+ *	The text is cut into integers by the tokenizer of chooseTokenizer().
+ *
+ * Invoked from:	
+ *	pass1()
+ *	buildTree()
+ *	buildBitsets()
+ *
+ * Input parameters:
+ *	reader		-> The reader to be opened
+ *	fileName	-> File name of the DB, "-" = stdin
+ *	dict		-> Dictionary of the item IDs; the reader does not add new
+ *			   IDs to it unless reader->grow is set
+ *	tokenizer	-> The tokenizer asked for, TOKENIZE_xxx
+ *	hugePages	-> Huge page policy of the buffers, HUGE_xxx
+ */
+static void openReader(TransReader *reader, const char *fileName, ItemDict *dict, int tokenizer, int hugePages)
+{
+ unsigned char *magic;
+ size_t bytes, size;
+ int format = DATA_TEXT;
+ int n;
+#if defined(HAVE_ZLIB) || defined(HAVE_ZSTD)
+ int fds[2];
+#endif
+
+ if (strcmp(fileName, "-") == 0)
+	reader->fp = stdin;
+ else if ((reader->fp = fopen(fileName, "r")) == NULL) {
+        throw FPError(string("Can't open data file, ") + fileName + ".");
+ }
+ reader->src = NULL;
+ reader->inflater = NULL;
+ reader->error[0] = '\0';
+ reader->tokenizer = chooseTokenizer(tokenizer);
+
+ /* The tokens, the text and the items in one big block; on huge pages, the
+    rest of the page holds the items */
+ bytes = sizeof(long long) * (READ_BLOCK / 2 + 1) + READ_BLOCK;
+ size = (hugePages != HUGE_OFF) ? (bytes + HUGE_PAGE - 1) & ~((size_t) HUGE_PAGE - 1) : bytes + sizeof(int) * 64;
+ reader->hugePages = hugePages;
+ reader->tokens = (long long *) bigAlloc(&reader->block, size, hugePages);
+ if (reader->tokens == NULL) {
+	throw FPError("out of memory");
+ }
+ reader->buf = (char *) (reader->tokens + READ_BLOCK / 2 + 1);
+ reader->items = (int *) (reader->buf + READ_BLOCK);
+ reader->size = (size - bytes) / sizeof(int);
+ reader->bufLen = reader->bufPos = 0;
+ reader->numTokens = reader->tokenPos = 0;
+ reader->atEnd = 0;
+
+ /* A DB in text starts with a digit or a blank; look at the magic bytes of anything else */
+ while ((reader->bufLen < 4) && ((n = readSome(reader->fp, reader->buf + reader->bufLen, 4 - reader->bufLen)) > 0))
+	reader->bufLen += n;
+ magic = (unsigned char *) reader->buf;
+ if ((reader->bufLen >= 2) && (magic[0] == 0x1f) && (magic[1] == 0x8b))
+	format = DATA_GZIP;
+ else if ((reader->bufLen == 4) && (memcmp(magic, "\x28\xb5\x2f\xfd", 4) == 0))
+	format = DATA_ZSTD;
+ else if ((reader->bufLen > 0) && ((magic[0] == 0x1f) || (magic[0] == 0x28))) {
+        throw FPError(string("Unknown format of data file, ") + fileName + ".");
+ }
+
+ if (format != DATA_TEXT) {
+#ifndef HAVE_ZLIB
+	if (format == DATA_GZIP) {
+	        throw FPError(string("Data file is gzip-compressed, build with HAVE_ZLIB to read it, ") + fileName + ".");
+	}
+#endif
+#ifndef HAVE_ZSTD
+	if (format == DATA_ZSTD) {
+	        throw FPError(string("Data file is zstd-compressed, build with HAVE_ZSTD to read it, ") + fileName + ".");
+	}
+#endif
+#if defined(HAVE_ZLIB) || defined(HAVE_ZSTD)
+	reader->src = reader->fp;
+	if ((pipe(fds) < 0) || ((reader->fp = fdopen(fds[0], "r")) == NULL)) {
+		throw FPError("Can't create the pipe of the inflater.");
+	}
+	reader->inflater = new thread(inflateStage, reader, format, string(reader->buf, reader->bufLen), fds[1]);
+	reader->bufLen = 0;
+#endif
+ }
+
+ reader->dict = dict;
+ reader->grow = 0;
+
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: nextTrans
+ *
+ * Description:
+ *	Read the next transaction of the DB into reader->items, as dense items
+ *	in ascending order.  Item IDs not in the dictionary are added to it if
+ *	reader->grow is set, otherwise skipped.  An item repeated in the
+ *	transaction is kept once, as stream() does, so no engine counts it twice
+ *	or inserts it twice on a path.
+ *
+ * Invoked from:	
+ *	pass1()
+ *	buildTree()
+ *	buildBitsets()
+ *
+ * Input parameters:
+ *	reader	-> An opened reader
+ *
+ * Return:
+ *	The transaction size, or -1 at the end of the DB.
+ *	A size < 0 or > INT_MAX, or a DB ending inside a transaction, is thrown.
+ */
+static int nextTrans(TransReader *reader)
+{
+ int transSize;
+ long long id;
+ int d, n, j;
+
+ /* Read the transaction size */
+ if ((reader->tokenPos == reader->numTokens) && (!fillTokens(reader)))
+	return -1;
+ id = reader->tokens[reader->tokenPos++];
+ if ((id < 0) || (id > INT_MAX)) {
+	throw FPError("Bad transaction size " + to_string(id) + " in the data file.");
+ }
+ transSize = id;
+
+ if (transSize > reader->size) {
+	bigFree(&reader->itemBlock);
+	reader->size = transSize;
+	reader->items = (int *) bigAlloc(&reader->itemBlock, sizeof(int) * reader->size, reader->hugePages);
+	if (reader->items == NULL) {
+		throw FPError("out of memory");
+	}
+ }
+
+ /* Read the items in the transaction */
+ n = 0;
+ for (j=0; j < transSize; j++) {
+	if ((reader->tokenPos == reader->numTokens) && (!fillTokens(reader))) {
+		throw FPError("The data file ends inside a transaction of " + to_string(transSize) + " items.");
+	}
+	id = reader->tokens[reader->tokenPos++];
+	if ((d = lookupDict(reader->dict, id, reader->grow)) >= 0)
+		reader->items[n++] = d;
+ }
+ sort(reader->items, reader->items + n);
+ n = unique(reader->items, reader->items + n) - reader->items;
+
+ return n;
+}
+
+
+/******************************************************************************************
+ * Function: releaseReader
+ *
+ * Description:
+ *	Close the database file of a reader, stop its inflater if the DB is
+ *	compressed, and free its buffers.  Nothing is thrown; a reader already
+ *	released, or never opened, is left as it is.
+ *
+ * Invoked from:	
+ *	closeReader()
+ *	~Transreader()
+ */
+static void releaseReader(TransReader *reader)
+{
+ if (reader->inflater != NULL) {
+	fclose(reader->fp);		/* Stops the inflater if it is not at the end */
+	reader->inflater->join();
+	delete reader->inflater;
+	reader->inflater = NULL;
+	reader->fp = reader->src;
+	reader->src = NULL;
+ }
+ if ((reader->fp != NULL) && (reader->fp != stdin))
+	fclose(reader->fp);
+ if ((reader->src != NULL) && (reader->src != stdin))
+	fclose(reader->src);
+ bigFree(&reader->itemBlock);
+ bigFree(&reader->block);
+ reader->fp = reader->src = NULL;
+ reader->items = NULL;
+ reader->buf = NULL;
+ reader->tokens = NULL;
+
+ return;
+}
+
+
+/*
+ * A reader still open when it goes out of scope, by an FPError thrown
+ * while the DB is scanned, is released here.
+ */
+Transreader::~Transreader()
+{
+ releaseReader(this);
+}
+
+
+/******************************************************************************************
+ * Function: closeReader
+ *
+ * Description:
+ *	Close the database file of a reader, and stop its inflater if the DB
+ *	is compressed.  A decompression error is only thrown here, as the
+ *	transactions just end at the error.
+ *
+ * Functions to be invoked:
+ *	releaseReader()
+ */
+static void closeReader(TransReader *reader)
+{
+ releaseReader(reader);
+ if (reader->error[0] != '\0') {
+	throw FPError(string("Can't decompress data file: ") + reader->error + ".");
+ }
+
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: loadConstraints
+ *
+ * Description:
+ *	Set up the item constraints of the job: flag the items of config.include
+ *	and config.exclude, and read the prices of config.priceFile if there is
+ *	a price limit.  Item IDs not in the DB are ignored; an item without a
+ *	price costs 0.  Without constraints, itemFlag stays NULL.
+ *
+ * Invoked from:	
+ *	pass1()
+ *	loadCheckpoint()
+ *
+ * Functions to be invoked:
+ *	lookupDict()
+ *
+ * Member variables:
+ *	itemFlag[]	-> itemFlag[item] = ITEM_INCLUDE and/or ITEM_EXCLUDE
+ *	itemPrice[]	-> itemPrice[item] = price of the item
+ *
+ * Member variables (read only):
+ *	dict		-> Item IDs of the database, numbered as mined
+ */
+void FPMiner::loadConstraints()
+{
+ const string *list[2] = {&config.include, &config.exclude};
+ const unsigned char flag[2] = {ITEM_INCLUDE, ITEM_EXCLUDE};
+ string buf;
+ char *tok, *save;
+ FILE *fp;
+ long long id;
+ float price;
+ int d, i;
+
+ if ((config.include.empty()) && (config.exclude.empty()) && (config.maxPrice <= 0))
+	return;
+
+ itemFlag = (unsigned char *) calloc (numItem + 1, sizeof(unsigned char));
+ if (itemFlag == NULL) {
+	throw FPError("out of memory");
+ }
+ for (i=0; i < 2; i++) {
+	buf = *list[i];
+	for (tok = strtok_r(&buf[0], ",", &save); tok != NULL; tok = strtok_r(NULL, ",", &save)) {
+		if ((d = lookupDict(&dict, atoll(tok), 0)) >= 0)
+			itemFlag[d] |= flag[i];
+	}
+ }
+
+ if (config.maxPrice > 0) {
+	itemPrice = (float *) calloc (numItem + 1, sizeof(float));
+	if (itemPrice == NULL) {
+		throw FPError("out of memory");
+	}
+	if (!config.priceFile.empty()) {
+		if ((fp = fopen(config.priceFile.c_str(), "r")) == NULL) {
+		        throw FPError(string("Can't open price file, ") + config.priceFile + ".");
+		}
+		while (fscanf(fp, "%lld %f", &id, &price) == 2) {
+			if ((d = lookupDict(&dict, id, 0)) >= 0)
+				itemPrice[d] = price;
+		}
+		fclose(fp);
+	}
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: satisfies
+ *
+ * Description:
+ *	Check an itemset against the item constraints.
+ *
+ * Invoked from:	
+ *	pass1()
+ *	addLargeItemset()
+ *
+ * Input parameters:
+ *	itemset	-> The k items
+ *	k	-> Size of the itemset
+ *
+ * Return:
+ *	1 if the itemset holds an item to include (if any is given), no item
+ *	to exclude, and is within the price limit; otherwise 0.
+ */
+int FPMiner::satisfies(const int *itemset, int k)
+{
+ float price = 0;
+ int flags = 0;
+ int i;
+
+ if (itemFlag == NULL)
+	return 1;
+ for (i=0; i < k; i++) {
+	flags |= itemFlag[itemset[i]];
+	if (itemPrice != NULL)
+		price += itemPrice[itemset[i]];
+ }
+ if ((!config.include.empty()) && ((flags & ITEM_INCLUDE) == 0))
+	return 0;
+ if (flags & ITEM_EXCLUDE)
+	return 0;
+ if ((itemPrice != NULL) && (price > config.maxPrice))
+	return 0;
+
+ return 1;
+}
+/******************************************************************************************
+ * Function: pass1()
+ *
+ * Description:
+ *	Scan the DB and find the support of each item.
+ *	The scan also finds the item IDs, which it numbers as dense items,
+ *	and the number of transactions; the values of the config. file are only hints.
+ *	Find the large 1-itemsets according to the support threshold.
+ *	Items that the item constraints rule out of every itemset are not large.
+ *
+ * Invoked from:	
+ *	build()
+ *
+ * Functions to be invoked:
+ *	openReader(), nextTrans(), closeReader()
+ *	q_sortD()
+ *	loadConstraints(), satisfies()
+ *
+ * Member variables:
+ *	largeItem1[]	-> Array to store 1-itemsets
+ *	support1[]	-> Support[i] = support of the 1-itemset stored in largeItem[i]
+ *	itemRank[]	-> itemRank[item] = i if largeItem1[i] = item is a large 1-item, otherwise -1
+ *	largeItemset[]	-> largeItemset[i] = resulting list for large (i+1)-itemsets
+ *	realK		-> Maximum size of itemset to be mined
+ *	numLarge[]	-> numLarge[i] = Number of large (i+1)-itemsets discovered so far
+ *	largeItemset[0]	-> Large 1-itemsets in descending order of support
+ *
+ *	numTrans	-> number of transactions in the database
+ *	numItem		-> number of items in the database
+ *	dict		-> Item IDs of the database
+ *	sampleTrans[], sampleLen[], numSample	-> Random sample of the transactions, if config.sample > 0
+ *	threshold	-> Support threshold
+ *
+ * Member variables (read only):
+ *	expectedK	-> User specified maximum size of itemset to be mined
+ *	config.dataFile	-> Database file
+ *	
+ */
+void FPMiner::pass1()
+{
+ int transSize;
+ int maxSize=0;
+ TransReader reader;
+ int i, j;
+ LargeItemPtr aLargeItemset;
+ vector<int> count;	/* count[d] = support of dense item d, in the order found */
+ vector<int> perm;	/* perm[d] = dense item d after renumbering */
+ unsigned long long rnd = 88172645463325252ULL;	/* State of the sampling PRNG */
+ long slot;
+
+ /* Initialize the support list, grown with the dictionary */
+ count.resize(dict.sizeKeys, 0);
+
+ /* scan DB to count the frequency of each item,
+  * finding the item IDs and the number of transactions */
+ openReader(&reader, config.dataFile.c_str(), &dict, config.tokenizer, config.hugePages);
+ reader.grow = 1;
+ report("tokenizer = %s\n", tokenizerName[reader.tokenizer]);
+
+ /* The reservoir of sampled transactions */
+ if (config.sample > 0) {
+	sampleTrans = (int **) calloc (config.sample, sizeof(int *));
+	sampleLen = (int *) calloc (config.sample, sizeof(int));
+	if ((sampleTrans == NULL) || (sampleLen == NULL)) {
+		throw FPError("out of memory");
+	}
+ }
+
+ /* Scan each transaction of the DB */
+ for (i=0; ; i++) {
+
+	/* Read the transaction */
+	if ((transSize = nextTrans(&reader)) < 0)
+		break;
+
+	/* Mark down the largest transaction size found so far */
+	if (transSize > maxSize)
+		maxSize = transSize;
+
+	if (dict.sizeKeys > (int) count.size())
+		count.resize(dict.sizeKeys, 0);
+
+	/* Count the items in the transaction */
+	for (j=0; j < transSize; j++)
+		count[reader.items[j]]++;
+
+	/* Reservoir sampling: keep transaction i with probability sample / (i+1) */
+	if (config.sample > 0) {
+		if (i < config.sample)
+			slot = numSample++;
+		else {
+			rnd ^= rnd << 13;
+			rnd ^= rnd >> 7;
+			rnd ^= rnd << 17;
+			slot = rnd % (i + 1);
+		}
+		if (slot < config.sample) {
+			sampleTrans[slot] = (int *) realloc (sampleTrans[slot], sizeof(int) * (transSize + 1));
+			if (sampleTrans[slot] == NULL) {
+				throw FPError("out of memory");
+			}
+			memcpy(sampleTrans[slot], reader.items, sizeof(int) * transSize);
+			sampleLen[slot] = transSize;
+		}
+	}
+ } 
+ closeReader(&reader);
+
+ if ((config.numTrans > 0) && (config.numTrans != i))
+	report("warning: the config. file says %d transactions, the DB has %d\n", config.numTrans, i);
+ if ((config.numItem > 0) && (config.numItem != dict.numKeys))
+	report("warning: the config. file says %d items, the DB has %d\n", config.numItem, dict.numKeys);
+ numTrans = i;
+ numItem = dict.numKeys;
+ report("numTrans = %d, numItem = %d\n", numTrans, numItem);
+
+ threshold = config.thresholdDecimal * numTrans;
+ if (threshold == 0) threshold = 1;
+ report("threshold = %d\n", threshold);
+
+ /* Number the dense items in the order of their item IDs */
+ support1 = (int *) malloc (sizeof(int) * (numItem + 1));
+ largeItem1 = (int *) malloc (sizeof(int) * (numItem + 1));
+ perm.resize(numItem + 1);
+ if ((support1 == NULL) || (largeItem1 == NULL)) {
+	throw FPError("out of memory");
+ }
+ sortDict(&dict, &perm[0]);
+ for (i=0; i < numItem; i++) { 
+	support1[perm[i]] = count[i];
+	largeItem1[i] = i;
+ }
+ for (i=0; i < numSample; i++) {
+	for (j=0; j < sampleLen[i]; j++)
+		sampleTrans[i][j] = perm[sampleTrans[i][j]];
+ }
+ loadConstraints();
+ 
+ /* Determine the upper limit of itemset size to be mined according to DB and user input. 
+  * If the user specified maximum itemset size (expectedK) is greater than 
+  * the largest transaction size (maxSize) in the database, or  exptectedK <= 0,
+  * then set  realK = maxSize;
+  * otherwise  realK = expectedK
+  */
+ realK = expectedK;
+ if ((maxSize < expectedK) || (expectedK <= 0))
+	realK = maxSize;
+ report("max transaction sizes = %d\n", maxSize);
+ report("max itemset size (K_max) to be mined  = %d\n", realK);
+
+ /* Initialize large k-itemset resulting list and corresponding support list */
+ largeItemset = (LargeItemPtr *) malloc (sizeof(LargeItemPtr) * realK); 
+ numLarge = (int *) malloc (sizeof(int) * realK);
+
+ if ((largeItemset == NULL) || (numLarge == NULL)) {
+	throw FPError("out of memory");
+ }
+
+ for (i=0; i < realK; i++)  {
+	largeItemset[i] = NULL;
+	numLarge[i] = 0;
+ }
+
+ /* Sort the supports of 1-itemsets in descending order */
+ q_sortD(&(support1[0]), largeItem1, 0, numItem-1, numItem);
+
+ /*
+ for (i=0; i < numItem; i++) 
+ 	printf("%d[%d] ", largeItem1[i], support1[i]);
+ printf("\n");
+ */
+
+ numLarge[0] = 0;
+ while ((numLarge[0] < numItem) && (support1[numLarge[0]] >= threshold))
+	(numLarge[0])++;
+
+ /* An item that no itemset may hold, by itself or by its price, is taken as not large:
+  * move it after the large 1-items, keeping their order */
+ if (itemFlag != NULL) {
+	vector<pair<int, int> > dropped;
+	for (i=0, j=0; i < numLarge[0]; i++) {
+		if (((itemFlag[largeItem1[i]] & ITEM_EXCLUDE) == 0) &&
+		    ((itemPrice == NULL) || (itemPrice[largeItem1[i]] <= config.maxPrice))) {
+			support1[j] = support1[i];
+			largeItem1[j++] = largeItem1[i];
+		} else
+			dropped.push_back(make_pair(support1[i], largeItem1[i]));
+	}
+	for (i=0; i < (int) dropped.size(); i++) {
+		support1[j + i] = dropped[i].first;
+		largeItem1[j + i] = dropped[i].second;
+	}
+	numLarge[0] = j;
+ }
+
+ report("\nNo. of large 1-itemsets (numLarge[0]) = %d\n", numLarge[0]);
+
+ /* Index the large 1-items by item ID */
+ itemRank = (int *) malloc (sizeof(int) * numItem);
+ if (itemRank == NULL) {
+	throw FPError("out of memory");
+ }
+ for (i=0; i < numItem; i++)
+	itemRank[i] = -1;
+ for (i=0; i < numLarge[0]; i++)
+	itemRank[largeItem1[i]] = i;
+
+ /* Store the large 1-itemsets, already in descending order of support */
+ for (i=numLarge[0]-1; i >= 0; i--) {
+	if (!satisfies(&largeItem1[i], 1))
+		continue;
+	aLargeItemset = (LargeItemPtr) malloc (sizeof(ItemsetNode));
+	if (aLargeItemset == NULL) {
+		throw FPError("out of memory");
+	}
+	aLargeItemset->itemset = (int *) malloc (sizeof(int));
+	if (aLargeItemset->itemset == NULL) {
+		throw FPError("out of memory");
+	}
+	aLargeItemset->itemset[0] = largeItem1[i];
+	aLargeItemset->support = support1[i];
+	aLargeItemset->next = largeItemset[0];
+	largeItemset[0] = aLargeItemset;
+ }
+
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: newRoot()
+ *
+ * Description:
+ *	Create the root of an FP-tree.
+ *	The root carries no item; its item ID is negative and its parent is NULL
+ *	so that bottom-up walks can recognise it.
+ *
+ * Invoked from:	
+ *	buildTree()
+ *	mineProjected()
+ */
+static FPTreeNode newRoot()
+{
+ FPTreeNode root;
+
+ root = (FPTreeNode) malloc (sizeof(FPNode));
+ if (root == NULL) {
+	throw FPError("out of memory");
+ }
+
+ root->item = -1;
+ root->count = 0;
+ root->numChildren = 0;
+ root->id = 0;
+ root->numPath = 1;
+ root->parent = NULL;
+ root->children = NULL;
+ root->hlink = NULL;
+
+ return root;
+}
+
+
+/******************************************************************************************
+ * Function: growArray
+ *
+ * Description:
+ *	Double the capacity of a growing array: of a conditional pattern base
+ *	or a conditional FP-tree.
+ *
+ * Input parameters:
+ *	a		-> The array
+ *	size		-> Its capacity, in elements; doubled
+ *	elemSize	-> Size of an element
+ *
+ * Return:
+ *	The array reallocated.
+ */
+static void *growArray(void *a, int *size, size_t elemSize)
+{
+ *size = (*size == 0) ? 1024 : *size * 2;
+ a = realloc(a, elemSize * (*size));
+ if (a == NULL) {
+	throw FPError("out of memory");
+ }
+ return a;
+}
+/******************************************************************************************
+ * Function: growBatch
+ *
+ * Description:
+ *	Move the items and ranks of a batch to a big block of their own, of
+ *	at least twice their capacity and enough for need of each.
+ *
+ * Invoked from:	
+ *	readBatch()
+ *
+ * Functions to be invoked:
+ *	bigAlloc(), bigFree()
+ *
+ * Input parameters:
+ *	batch	-> The batch
+ *	used	-> Items (and ranks) of the batch to be kept
+ *	need	-> Capacity needed
+ *	policy	-> Huge page policy of the block, HUGE_xxx
+ */
+static void growBatch(TransBatch *batch, int used, int need, int policy)
+{
+ BigBlock block;
+ int *items;
+ int size;
+
+ for (size = 2 * batch->sizeItems; size < need; size *= 2)
+	;
+ items = (int *) bigAlloc(&block, sizeof(int) * 2 * (size_t) size, policy);
+ if (items == NULL) {
+	throw FPError("out of memory");
+ }
+ memcpy(items, batch->items, sizeof(int) * used);
+ memcpy(items + size, batch->ranks, sizeof(int) * used);
+ bigFree(&batch->block);
+ batch->block = block;
+ batch->items = items;
+ batch->ranks = items + size;
+ batch->sizeItems = size;
+ return;
+}
+/*
+ * The batches of a ring are freed with it.
+ */
+Transring::~Transring()
+{
+ for (int i=0; i < RING_SLOTS; i++)
+	bigFree(&slot[i].block);
+ bigFree(&block);
+}
+/******************************************************************************************
+ * Function: readBatch
+ *
+ * Description:
+ *	Read the next transactions of the DB into a batch: keep the large items
+ *	of each transaction, with their ranks, and sort them in ascending order
+ *	of rank, i.e. the order of the large 1-itemset list.  A transaction
+ *	without any of the items to include is read but left out of the batch.
+ *
+ * Invoked from:	
+ *	buildTree()
+ *	readStage()
+ *
+ * Functions to be invoked:
+ *	nextTrans(), q_sortA(), growBatch()
+ *
+ * Input parameters:
+ *	reader		-> The open reader of the DB
+ *	maxTrans	-> Number of transactions left to read
+ *
+ * Output parameter:
+ *	batch	-> The transactions read
+ *
+ * Return:
+ *	The number of transactions read, 0 at the end of the DB.
+ */
+int FPMiner::readBatch(TransReader *reader, TransBatch *batch, int maxTrans)
+{
+ int transSize, count, off;
+ int item;
+ int i, j;
+
+ batch->numTrans = 0;
+ off = 0;
+ for (i=0; (i < BATCH_TRANS) && (i < maxTrans); i++) {
+
+	/* Read the transaction */
+	if ((transSize = nextTrans(reader)) < 0)
+		break;
+
+	if (off + transSize > batch->sizeItems)
+		growBatch(batch, off, off + transSize, config.hugePages);
+
+	/* Keep the large 1-items with the positions in the large 1-itemset list */
+	count = 0;
+	for (j=0; j < transSize; j++) {
+		item = reader->items[j];
+		if (itemRank[item] >= 0) {
+			batch->items[off + count] = item;
+			batch->ranks[off + count] = itemRank[item];
+			count++;
+		}
+	}
+
+	/* A transaction without any of the items to include holds no itemset wanted */
+	if ((itemFlag != NULL) && (!config.include.empty())) {
+		for (j=0; (j < count) && ((itemFlag[batch->items[off + j]] & ITEM_INCLUDE) == 0); j++)
+			;
+		if (j == count)
+			continue;
+	}
+
+	q_sortA(batch->ranks + off, batch->items + off, 0, count-1, count);
+	batch->len[batch->numTrans++] = count;
+	off += count;
+ }
+
+ return i;
+}
+/******************************************************************************************
+ * Function: insertBatch
+ *
+ * Description:
+ *	Insert the transactions of a batch into the initial FP-tree.
+ *	The insertion stops if the tree exceeds the memory budget.
+ *
+ * Invoked from:	
+ *	buildTree()
+ *
+ * Functions to be invoked:
+ *	insert_tree()
+ *
+ * Input parameters:
+ *	batch	-> The transactions, as read by readBatch()
+ *	root	-> Root of the FP-tree
+ *
+ * Member variables:
+ *	headerTableLink	-> Header table of the FP-tree
+ *	treeOverflow	-> Set if the FP-tree exceeds the memory budget
+ */
+void FPMiner::insertBatch(TransBatch *batch, FPTreeNode root)
+{
+ int path;
+ int t, off;
+
+ for (t=0, off=0; (t < batch->numTrans) && (!treeOverflow); off += batch->len[t], t++) {
+	path = 0;
+	insert_tree(batch->items + off, batch->ranks + off, 1, 0, batch->len[t], root, headerTableLink, &path);
+ }
+ return;
+}
+/******************************************************************************************
+ * Function: readStage
+ *
+ * Description:
+ *	The reader thread of a pipelined buildTree(): read the DB batch by batch
+ *	into the ring, waiting while the ring is full, until the end of the DB
+ *	or until the inserter stops it.  An error is left in ring->error.
+ *
+ * Invoked from:	
+ *	buildTree(), as a thread
+ *
+ * Functions to be invoked:
+ *	openReader(), readBatch(), closeReader()
+ *
+ * Input parameters:
+ *	ring	-> The ring shared with the inserter
+ */
+void FPMiner::readStage(TransRing *ring)
+{
+ TransReader reader;
+ chrono::steady_clock::time_point start;
+ long head;
+ int left = numTrans;
+ int n;
+
+ try {
+	openReader(&reader, config.dataFile.c_str(), &dict, config.tokenizer, config.hugePages);
+	for (head=0; (left > 0) && (!ring->stop.load(memory_order_acquire)); head++) {
+
+		/* Backpressure: wait for the inserter to empty a slot */
+		if (head - ring->tail.load(memory_order_acquire) == RING_SLOTS) {
+			ring->readStalls++;
+			while ((head - ring->tail.load(memory_order_acquire) == RING_SLOTS) &&
+			       (!ring->stop.load(memory_order_acquire)))
+				this_thread::yield();
+			if (ring->stop.load(memory_order_acquire))
+				break;
+		}
+
+		start = chrono::steady_clock::now();
+		n = readBatch(&reader, &ring->slot[head % RING_SLOTS], left);
+		ring->readSecs += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		if (n == 0)
+			break;
+		left -= n;
+		ring->numRead += n;
+		ring->head.store(head + 1, memory_order_release);
+	}
+	closeReader(&reader);
+ } catch (FPError &e) {
+	ring->error = e.what();
+ } catch (bad_alloc &) {
+	ring->error = "out of memory";
+ }
+ ring->done.store(1, memory_order_release);
+
+ return;
+}
+/******************************************************************************************
+ * Function: buildTree()
+ *
+ * Description:
+ *	Build the initial FP-tree.
+ *	Unless config.numThreads is 1, the build is a pipeline: a reader thread
+ *	(readStage()) parses and ranks the transactions into a ring of batches
+ *	while this thread inserts them into the tree.  The time and throughput
+ *	of both stages, and how often each waited for the other, are reported.
+ *	The building stops as soon as the tree exceeds the memory budget.
+ *
+ * Invoked from:	
+ *	build()
+ *
+ * Functions to be invoked:
+ *	readStage()	-> The reader thread
+ *	openReader(), readBatch(), closeReader()
+ *	insertBatch()
+ *	bigAlloc()
+ *
+ * Member variables:
+ *	root		-> Pointer to the root of this initial FP-tree
+ *	headerTableLink	-> Header table for this initial FP-tree
+ *
+ * Member variables (read only):
+ *	numLarge[]	-> Large k-itemsets resulting list for k = 1 to realK
+ *	itemRank[]	-> Position of each large 1-item in the large 1-item list
+ *
+ * Return:
+ *	1 if the FP-tree is built, 0 if it exceeds the memory budget.
+ */
+int FPMiner::buildTree(FPTreeNode& root)
+{
+ unique_ptr<TransRing> ring;	/* The batches between the stages */
+ TransReader reader;	/* Reader of the database file */
+ TransBatch *batch;
+ chrono::steady_clock::time_point start;
+ size_t bytes;
+ int *mem;
+ long tail;
+ long inserted = 0;	/* Number of transactions inserted */
+ int left, n;
+ int i;
+
+
+ /* Create header table */
+ headerTableLink = (FPTreeNode *) malloc (sizeof(FPTreeNode) * numLarge[0]);
+ if (headerTableLink == NULL) {
+	throw FPError("out of memory");
+ }
+ for (i=0; i < numLarge[0]; i++)
+	headerTableLink[i] = NULL;
+	
+ /* Create root of the FP-tree */
+ root = newRoot();
+ treeBytes = 0;
+ treeOverflow = 0;
+ numNodes = 1;
+ treeThreshold = threshold;
+
+ /* Create the batches of transactions, in one big block; on huge pages,
+    the items of the batches take the rest of the page */
+ ring.reset(new TransRing);
+ bytes = RING_SLOTS * sizeof(int) * (BATCH_TRANS + 2 * BATCH_TRANS * 16);
+ if (config.hugePages != HUGE_OFF)
+	bytes = (bytes + HUGE_PAGE - 1) & ~((size_t) HUGE_PAGE - 1);
+ mem = (int *) bigAlloc(&ring->block, bytes, config.hugePages);
+ if (mem == NULL) {
+	throw FPError("out of memory");
+ }
+ n = bytes / sizeof(int) / RING_SLOTS;		/* Ints of a batch */
+ for (i=0; i < RING_SLOTS; i++) {
+	ring->slot[i].len = mem + (size_t) i * n;
+	ring->slot[i].sizeItems = (n - BATCH_TRANS) / 2;
+	ring->slot[i].items = ring->slot[i].len + BATCH_TRANS;
+	ring->slot[i].ranks = ring->slot[i].items + ring->slot[i].sizeItems;
+ }
+
+ /* scan DB and insert frequent items into the FP-tree */
+ if (config.numThreads == 1) {
+	/* One thread: read a batch, then insert it */
+	openReader(&reader, config.dataFile.c_str(), &dict, config.tokenizer, config.hugePages);
+	batch = &ring->slot[0];
+	for (left = numTrans; (left > 0) && (!treeOverflow); left -= n) {
+		start = chrono::steady_clock::now();
+		n = readBatch(&reader, batch, left);
+		ring->readSecs += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		if (n == 0)
+			break;
+		ring->numRead += n;
+
+		start = chrono::steady_clock::now();
+		insertBatch(batch, root);
+		ring->insertSecs += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		inserted += batch->numTrans;
+	}
+	closeReader(&reader);
+ } else {
+	/* Pipeline: the reader thread fills the ring, this thread empties it */
+	thread readerThread(&FPMiner::readStage, this, ring.get());
+	try {
+		for (tail=0; !treeOverflow; tail++) {
+			if (tail == ring->head.load(memory_order_acquire)) {
+				ring->insertStalls++;
+				while ((tail == ring->head.load(memory_order_acquire)) && (!ring->done.load(memory_order_acquire)))
+					this_thread::yield();
+				if (tail == ring->head.load(memory_order_acquire))
+					break;
+			}
+
+			batch = &ring->slot[tail % RING_SLOTS];
+			start = chrono::steady_clock::now();
+			insertBatch(batch, root);
+			ring->insertSecs += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			inserted += batch->numTrans;
+			ring->tail.store(tail + 1, memory_order_release);
+		}
+	} catch (...) {
+		/* The reader must be stopped before the ring goes away */
+		ring->stop.store(1, memory_order_release);
+		readerThread.join();
+		throw;
+	}
+	ring->stop.store(1, memory_order_release);
+	readerThread.join();
+ }
+
+ report("reader: %.3f secs, %.0f trans/sec, %ld waits on a full ring\n", ring->readSecs,
+	(ring->readSecs > 0) ? ring->numRead / ring->readSecs : 0.0, ring->readStalls);
+ report("inserter: %.3f secs, %.0f trans/sec, %ld waits on an empty ring\n", ring->insertSecs,
+	(ring->insertSecs > 0) ? inserted / ring->insertSecs : 0.0, ring->insertStalls);
+
+ if (!ring->error.empty()) {
+	throw FPError(ring->error);
+ }
+
+ return !treeOverflow;
+}
+/******************************************************************************************
+ * Function: relayoutTree
+ *
+ * Description:
+ *	Move the nodes of the built FP-tree, malloc'ed one by one as they were
+ *	inserted, into one array in depth-first order, and relink the header
+ *	table chains in that order.  A chain is then walked forward in memory,
+ *	and the prefix paths climbed from its nodes lie just before them.
+ *	The nodes get their index in the array as id.
+ *	The arrays are big blocks, on huge pages if config.hugePages lets them,
+ *	and are first written here, by the thread that built the tree.
+ *
+ * Invoked from:	
+ *	build()
+ *	loadCheckpoint()
+ *
+ * Functions to be invoked:
+ *	destroyTree()
+ *	bigAlloc(), bigFree()
+ *
+ * Member variables:
+ *	root, headerTableLink	-> The FP-tree
+ *	nodeArena, childArena	-> Its nodes and their children entries
+ *	nodeBlock, childBlock	-> Their memory
+ *	numNodes		-> (read only) Number of nodes, root included
+ */
+void FPMiner::relayoutTree()
+{
+ vector<FPTreeNode> stack;
+ vector<FPTreeNode> tail(numLarge[0], (FPTreeNode) NULL);	/* tail[r] = last node of chain r */
+ vector<childLink> lastChild(numNodes, (childLink) NULL);	/* lastChild[id] = last children entry */
+ BigBlock newNodes, newChildren;
+ FPNode *arena;
+ ChildNode *entries;
+ FPTreeNode node, copy;
+ childLink link;
+ int n, r, pushed;
+
+ arena = (FPNode *) bigAlloc(&newNodes, sizeof(FPNode) * numNodes, config.hugePages);
+ entries = (ChildNode *) bigAlloc(&newChildren, sizeof(ChildNode) * numNodes, config.hugePages);
+ if ((arena == NULL) || (entries == NULL)) {
+	bigFree(&newNodes);
+	bigFree(&newChildren);
+	report("no memory to lay out the FP-tree\n");
+	return;
+ }
+ report("FP-tree arena: %.1f MB on %s pages\n",
+	(newNodes.bytes + newChildren.bytes) / 1048576.0, pagesName[newNodes.pages]);
+
+ /* Copy the nodes in preorder; a node's parent is copied before it.
+  * The old parent pointer is mapped through the id of the parent,
+  * which is already set to its new index. */
+ for (r=0; r < numLarge[0]; r++)
+	headerTableLink[r] = NULL;
+ n = 0;
+ stack.push_back(root);
+ while (!stack.empty()) {
+	node = stack.back();
+	stack.pop_back();
+
+	copy = &arena[n];
+	*copy = *node;
+	copy->children = NULL;
+	copy->hlink = NULL;
+	if (node->parent != NULL) {
+		copy->parent = &arena[node->parent->id];
+		r = itemRank[node->item];
+		if (tail[r] == NULL)
+			headerTableLink[r] = copy;
+		else
+			tail[r]->hlink = copy;
+		tail[r] = copy;
+
+		/* Append the entry to the children of the parent, in the old order */
+		entries[n].node = copy;
+		entries[n].next = NULL;
+		if (lastChild[copy->parent->id] == NULL)
+			copy->parent->children = &entries[n];
+		else
+			lastChild[copy->parent->id]->next = &entries[n];
+		lastChild[copy->parent->id] = &entries[n];
+	}
+	node->id = n;
+	copy->id = n++;
+
+	/* Children go on the stack in reverse, so the first is copied next */
+	pushed = 0;
+	for (link = node->children; link != NULL; link = link->next, pushed++)
+		stack.push_back(link->node);
+	reverse(stack.end() - pushed, stack.end());
+ }
+
+ if (nodeArena != NULL) {
+	bigFree(&nodeBlock);
+	bigFree(&childBlock);
+ } else
+	destroyTree(root);
+ nodeBlock = newNodes;
+ childBlock = newChildren;
+ nodeArena = arena;
+ childArena = entries;
+ root = &arena[0];
+
+ return;
+}
+/******************************************************************************************
+ * Function: setOption
+ *
+ * Description:
+ *	Store one optional parameter of a mining job.
+ *	Optional parameters follow the six fixed lines of the config. file,
+ *	one "<name> <value>" pair per line:
+ *	ruleFile <file>		-> Generate association rules into this file
+ *	minConf <c>		-> Minimum confidence of a rule, range: [0, 1] (default 0)
+ *	minLift <l>		-> Minimum lift of a rule (default 0)
+ *	numThreads <n>		-> Number of worker threads, 0 = one per CPU (default 0);
+ *				   with 1, buildTree() reads and inserts in one thread
+ *	engine <name>		-> Mining engine: auto, fptree, fpgrowth, patricia,
+ *				   bitset, eclat or declat (default auto)
+ *	memBudget <MB>		-> Memory budget of the FP-tree; a larger DB is partitioned
+ *				   into projected DBs on disk (default 0 = no limit)
+ *	verbose <0|1>		-> Report progress and timing on stdout (default 1)
+ *	window <n>		-> Stream mode: mine the sliding window of the last n
+ *				   transactions (default 0 = no streaming)
+ *	batch <n>		-> Stream mode: transactions inserted/expired at a time (default 64)
+ *	emitEvery <n>		-> Stream mode: transactions between outputs (default window)
+ *	sample <n>		-> Preflight mode: estimate the results from a random sample
+ *				   of n transactions (default 0 = no preflight)
+ *	sampleThresholds <t,t,...> -> Preflight mode: thresholds to estimate (default the threshold)
+ *	verifySample <0|1>	-> Preflight mode: count the itemsets found in the sample
+ *				   in the full DB (default 0)
+ *	checkpoint <file>	-> Save the mining progress of the fpgrowth engine to this file
+ *				   (and <file>.log), and resume from it (default none)
+ *	checkpointEvery <secs>	-> Seconds between two checkpoints (default 600)
+ *	include <id,id,...>	-> Only itemsets holding one of these items (default any),
+ *				   not with a ruleFile
+ *	exclude <id,id,...>	-> Only itemsets holding none of these items (default none)
+ *	priceFile <file>	-> Prices of the items, one "<item ID> <price>" per line
+ *	maxPrice <p>		-> Only itemsets of total price <= p (default 0 = no limit)
+ *	relayout <0|1>		-> Lay the built FP-tree out in depth-first order (default 1)
+ *	counters <0|1>		-> Report the node visits and simulated cache misses
+ *				   of building the pattern bases (default 0)
+ *	shards <n>		-> Mine in n worker processes, each over a range of the
+ *				   ranks of the large items (default 0 = in this process)
+ *	query <socket|->	-> Query mode: answer itemset support queries from the
+ *				   FP-tree on a Unix socket or stdin, instead of mining
+ *	tokenizer <name>	-> Tokenizer of the text of the DB: auto, scalar, sse4 or avx2;
+ *				   one the CPU does not have falls back to a slower one (default auto)
+ *	outOrder <support|items> -> Order of the itemsets of a size in the result file: by
+ *				   support, or by item IDs with an external merge sort (default support)
+ *	sortRun <n>		-> outOrder items: itemsets sorted in memory at a time (default 1048576)
+ *	verify <n>		-> Verify mode: check every engine against a brute-force count
+ *				   on n random DBs, instead of mining (default 0)
+ *	hugePages <auto|thp|off> -> Pages of the big blocks (FP-tree arenas, bitsets, tid-lists,
+ *				   buffers of the reader and of the ring of batches): explicit huge
+ *				   pages if the pool has them, else transparent ones (auto),
+ *				   transparent ones only (thp), or small ones (default auto)
+ *	numa <0|1>		-> Bind the shard workers to NUMA nodes, in turn (default 1);
+ *				   the build in this process is not bound
+ *
+ * Invoked from:	
+ *	input()
+ *
+ * Functions to be invoked: None
+ *
+ * Input parameters:
+ *	name	-> Name of the parameter
+ *	value	-> Value of the parameter
+ *
+ * Output parameter:
+ *	config	-> The parameters of the job
+ *
+ * Return:
+ *	1 if the parameter is stored, 0 if the name or the value is unknown.
+ */
+int setOption(FPConfig *config, const char *name, const char *value)
+{
+ int i;
+
+ if (strcmp(name, "ruleFile") == 0)
+	config->ruleFile = value;
+ else if (strcmp(name, "minConf") == 0)
+	config->minConf = atof(value);
+ else if (strcmp(name, "minLift") == 0)
+	config->minLift = atof(value);
+ else if (strcmp(name, "numThreads") == 0)
+	config->numThreads = atoi(value);
+ else if (strcmp(name, "memBudget") == 0)
+	config->memBudget = (long) (atof(value) * 1048576);
+ else if (strcmp(name, "verbose") == 0)
+	config->verbose = atoi(value);
+ else if (strcmp(name, "window") == 0)
+	config->window = atoi(value);
+ else if (strcmp(name, "batch") == 0)
+	config->batch = atoi(value);
+ else if (strcmp(name, "emitEvery") == 0)
+	config->emitEvery = atoi(value);
+ else if (strcmp(name, "sample") == 0)
+	config->sample = atoi(value);
+ else if (strcmp(name, "sampleThresholds") == 0)
+	config->sampleThresholds = value;
+ else if (strcmp(name, "verifySample") == 0)
+	config->verifySample = atoi(value);
+ else if (strcmp(name, "checkpoint") == 0)
+	config->checkpointFile = value;
+ else if (strcmp(name, "checkpointEvery") == 0)
+	config->checkpointEvery = atoi(value);
+ else if (strcmp(name, "include") == 0)
+	config->include = value;
+ else if (strcmp(name, "exclude") == 0)
+	config->exclude = value;
+ else if (strcmp(name, "priceFile") == 0)
+	config->priceFile = value;
+ else if (strcmp(name, "maxPrice") == 0)
+	config->maxPrice = atof(value);
+ else if (strcmp(name, "relayout") == 0)
+	config->relayout = atoi(value);
+ else if (strcmp(name, "counters") == 0)
+	config->counters = atoi(value);
+ else if (strcmp(name, "shards") == 0)
+	config->shards = atoi(value);
+ else if (strcmp(name, "query") == 0)
+	config->query = value;
+ else if (strcmp(name, "sortRun") == 0)
+	config->sortRun = atoi(value);
+ else if (strcmp(name, "verify") == 0)
+	config->verify = atoi(value);
+ else if (strcmp(name, "numa") == 0)
+	config->numa = atoi(value);
+ else if (strcmp(name, "hugePages") == 0) {
+	if (strcmp(value, "auto") == 0)
+		config->hugePages = HUGE_AUTO;
+	else if (strcmp(value, "thp") == 0)
+		config->hugePages = HUGE_THP;
+	else if (strcmp(value, "off") == 0)
+		config->hugePages = HUGE_OFF;
+	else
+		return 0;
+ }
+ else if (strcmp(name, "outOrder") == 0) {
+	if (strcmp(value, "support") == 0)
+		config->outOrder = OUT_SUPPORT;
+	else if (strcmp(value, "items") == 0)
+		config->outOrder = OUT_ITEMS;
+	else
+		return 0;
+ } else if (strcmp(name, "engine") == 0) {
+	for (i=0; i < NUM_ENGINE; i++) {
+		if (strcmp(value, engineName[i]) == 0)
+			break;
+	}
+	if (i == NUM_ENGINE)
+		return 0;
+	config->engine = i;
+ } else if (strcmp(name, "tokenizer") == 0) {
+	for (i=0; i < NUM_TOKENIZE; i++) {
+		if (strcmp(value, tokenizerName[i]) == 0)
+			break;
+	}
+	if (i == NUM_TOKENIZE)
+		return 0;
+	config->tokenizer = i;
+ } else
+	return 0;
+
+ return 1;
+}
+
+
+/******************************************************************************************
+ * Function: input
+ *
+ * Description:
+ *	Read the parameters of a mining job from the configuration file.
+ *
+ * Invoked from:	
+ *	main()
+ *
+ * Functions to be invoked:
+ *	setOption()	-> Store an optional parameter
+ *
+ * Input parameters:
+ *	*configFile	-> The configuration file
+ *
+ * Output parameter:
+ *	config	-> expectedK, thresholdDecimal, numItem, numTrans, dataFile, outFile
+ *		   and the optional parameters, see setOption()
+ */
+void input(const char *configFile, FPConfig *config)
+{
+ ifstream in(configFile);
+ string name, value;
+
+ if (!in)
+	throw FPError(string("Can't open config. file, ") + configFile + ".");
+
+ in >> config->expectedK >> config->thresholdDecimal >> config->numItem >> config->numTrans;
+ in >> config->dataFile >> config->outFile;
+
+ /* Optional parameters follow as <name> <value> pairs */
+ while (in >> name >> value) {
+	if (!setOption(config, name.c_str(), value.c_str())) {
+		throw FPError("Unknown parameter in config. file, " + name + " " + value + ".");
+	}
+ }
+
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: FPMiner
+ *
+ * Description:
+ *	Create a mining job with the given parameters.
+ *	Nothing is read until build().
+ *
+ * Input parameters:
+ *	config	-> The parameters of the job
+ */
+FPMiner::FPMiner(const FPConfig &config)
+{
+ this->config = config;
+
+ largeItemset = NULL;
+ numLarge = NULL;
+ support1 = NULL;
+ largeItem1 = NULL;
+ itemRank = NULL;
+ root = NULL;
+ headerTableLink = NULL;
+ patRoot = NULL;
+ patHeader = NULL;
+ itemsetIndex = NULL;
+ itemRuns = NULL;
+ numSpilled = 0;
+ spillRuns = 0;
+ tidBits = NULL;
+ tidLists = NULL;
+ memset(&condBase, 0, sizeof(condBase));
+ sampleTrans = NULL;
+ sampleLen = NULL;
+ numSample = 0;
+ ckptLog = NULL;
+ ckptRank = -1;
+ ckptMark = NULL;
+ ckptTime = 0;
+ itemFlag = NULL;
+ itemPrice = NULL;
+ nodeArena = NULL;
+ childArena = NULL;
+ memset(&nodeBlock, 0, sizeof(nodeBlock));
+ memset(&childBlock, 0, sizeof(childBlock));
+ memset(&bitBlock, 0, sizeof(bitBlock));
+ memset(&tidBlock, 0, sizeof(tidBlock));
+ simTag = NULL;
+ walkSteps = 0;
+ walkMisses = 0;
+ minRank = 0;
+ memset(queryHist, 0, sizeof(queryHist));
+ numQueries = 0;
+ queryMax = 0;
+ numWords = 0;
+ treeBytes = 0;
+ treeOverflow = 0;
+ numNodes = 0;
+ zeroNodes = 0;
+ realK = 0;
+
+ expectedK = config.expectedK;
+ numItem = config.numItem;
+ numTrans = config.numTrans;
+ engine = config.engine;
+
+ report("expectedK = %d\n", expectedK);
+ report("thresholdDecimal = %f\n", config.thresholdDecimal);
+ report("numItem = %d\n", numItem);
+ report("numTrans = %d\n", numTrans);
+ report("dataFile = %s\n", config.dataFile.c_str());
+ report("outFile = %s\n\n", config.outFile.c_str());
+ threshold = 1;		/* Set by pass1() once numTrans is known */
+ initDict(&dict);
+}
+
+
+/******************************************************************************************
+ * Function: ~FPMiner
+ *
+ * Description:
+ *	Free all the memory of the job.
+ */
+FPMiner::~FPMiner()
+{
+ destroy();
+}
+
+
+/******************************************************************************************
+ * Function: report
+ *
+ * Description:
+ *	printf() the progress of the job, unless it is not verbose.
+ */
+void FPMiner::report(const char *format, ...)
+{
+ va_list args;
+
+ if (!config.verbose) return;
+
+ va_start(args, format);
+ vprintf(format, args);
+ va_end(args);
+ return;
+}
+/******************************************************************************************
+ *Function: show_time
+ *
+ *Description:
+ *	will be used later
+ *
+ */
+void FPMiner::show_time(int i){
+	float time=(float)clock()/CLOCKS_PER_SEC;
+	report("time %d: %.4f secs.\n", i, time);
+}
+/******************************************************************************************
+ *Function: combination_node(string s)
+ *
+ *Description: fastest combination using string
+ *	Every combination of the items on the path from pnode up to the root
+ *	is added to mp with count cc.  The key of an itemset is the raw bytes
+ *	of its item IDs (leaf to root order), so any item ID can be encoded.
+ *	Combinations longer than maxK are not generated.
+ *	The tree is not modified.
+ *	
+ */
+void FPMiner::combination_node(FPTreeNode pnode, int cc, map<string, int> & mp, int maxK)
+{
+	if(cc<1)
+		return;
+	//by node, form the item list alpha first
+	vector<int> alpha;
+	FPTreeNode t = pnode;
+	while(t->parent != NULL)//from leaf to root into a vector, then combination the vector
+	{
+		alpha.push_back(t->item);
+		t = t->parent;
+	}
+	//cout<<pnode->item<<" combintation: "<<alpha<<" count: "<<cc<<endl;
+
+
+	string s;//string is recycle use, so clear it after use in loops: s.clear();
+	vector<int> indx;
+	int n = alpha.size();
+	int j=1;
+	int k=(n < maxK) ? n : maxK;
+	int count = cc;
+	int r;
+	bool done;
+	map<string, int>::iterator mapit;
+	for(int twk=j;twk<=k;twk++){
+		r=twk;
+		done=true;
+		for(int iwk=0;iwk<r;iwk++)
+			indx.push_back(iwk);
+		while(done){
+			done=false;
+			for(int owk=0;owk<r;owk++){
+				s.append((const char *) &alpha[indx[owk]], sizeof(int));
+				//myfile<<alpha[indx[owk]];
+			}
+			//insert into map:
+			if((mapit = mp.find(s)) == mp.end())
+			{
+				mp.insert(make_pair(s,cc));
+			}
+			else
+			{
+				mapit->second += cc;
+			}
+			
+			s.clear();//reuse the string
+				for(int iwk=r-1;iwk>=0;iwk--){
+				if(indx[iwk]<=(n-1)-(r-iwk)){
+					indx[iwk]++;
+					for(int swk=iwk+1;swk<r;swk++){
+						indx[swk]=indx[swk-1]+1;
+					}
+					iwk=-1;
+					done=true;
+				}	
+			}
+		}
+		indx.clear();
+	}
+}
+/******************************************************************************************
+ * Function: countAccess
+ *
+ * Description:
+ *	Count a node visit of a pattern base walk, and whether it misses a
+ *	simulated cache of SIM_CACHE_LINES lines of 64 bytes, direct mapped.
+ *	The simulation is only meant to compare layouts of the same tree.
+ *
+ * Invoked from:	
+ *	loop_same_items()
+ *	condTreeBase()
+ *
+ * Member variables:
+ *	simTag[]	-> simTag[i] = line held by line i of the cache
+ *	walkSteps, walkMisses	-> The counters
+ */
+inline void FPMiner::countAccess(const void *addr)
+{
+ unsigned long long line = (unsigned long long) addr >> 6;
+
+ walkSteps++;
+ if (simTag[line & (SIM_CACHE_LINES - 1)] != line) {
+	simTag[line & (SIM_CACHE_LINES - 1)] = line;
+	walkMisses++;
+ }
+ return;
+}
+/******************************************************************************************
+ * Function: loop_same_items
+ *
+ * Description:
+ *	Build the conditional pattern base of an item into condBase
+ *	in one pass over the item's chain of nodes: for each node, its prefix
+ *	path is emitted into the flat buffer condBase.ranks, with the count of
+ *	the node, and the count is added to the support of each rank on the path.
+ *	The paths are not filtered here, as the supports are only known at the end;
+ *	the ranks below threshold are dropped when the conditional FP-tree is built.
+ *
+ * Invoked from:	
+ *	fpGrowth()
+ *
+ * Functions to be invoked:
+ *	growArray()
+ *
+ * Input parameters:
+ *	hnode	-> First node of the item's chain
+ *	numRank	-> All the ranks on the prefix paths are below numRank
+ *
+ * Member variables:
+ *	condBase	-> The conditional pattern base
+ *	itemRank[]	-> (read only)
+ *	simTag, walkSteps, walkMisses	-> The counters, if any
+ */
+void FPMiner::loop_same_items(FPTreeNode hnode, int numRank)
+{
+ CondBase *base = &condBase;
+ FPTreeNode p, t;
+ int start, r;
+
+ base->numPaths = 0;
+ base->numRanks = 0;
+ memset(base->support, 0, sizeof(int) * numRank);
+
+ for (p = hnode; p != NULL; p = p->hlink) {
+	/* The next node of the chain is fetched while the path is climbed */
+	PREFETCH(p->hlink);
+	if (simTag != NULL) {
+		for (t = p; t->parent != NULL; t = t->parent)
+			countAccess(t);
+	}
+	start = base->numRanks;
+	for (t = p->parent; t->parent != NULL; t = t->parent) {
+		if (base->numRanks == base->sizeRanks)
+			base->ranks = (int *) growArray(base->ranks, &base->sizeRanks, sizeof(int));
+		r = itemRank[t->item];
+		base->ranks[base->numRanks++] = r;
+		base->support[r] += p->count;
+	}
+	if (base->numRanks == start)
+		continue;
+
+	/* Paths are walked upwards; store them root first, as they are inserted */
+	reverse(base->ranks + start, base->ranks + base->numRanks);
+	if (base->numPaths == base->sizePaths) {
+		r = base->sizePaths;
+		base->pathLen = (int *) growArray(base->pathLen, &r, sizeof(int));
+		base->pathCount = (int *) growArray(base->pathCount, &base->sizePaths, sizeof(int));
+	}
+	base->pathLen[base->numPaths] = base->numRanks - start;
+	base->pathCount[base->numPaths] = p->count;
+	base->numPaths++;
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: pruneCond
+ *
+ * Description:
+ *	Push the item constraints down into the conditional FP-tree of rank r,
+ *	whose pattern base is in condBase: the tree is not built at all if
+ *	neither it nor the suffix can hold an item to include, and it leaves
+ *	out the items over the price left by the suffix and the item.
+ *
+ * Invoked from:	
+ *	fpGrowth()
+ *	condGrowth()
+ *
+ * Input parameters:
+ *	r		-> Rank of the item
+ *	suffixIncl	-> The suffix holds an item to include
+ *	suffixPrice	-> Total price of the suffix
+ *
+ * Output parameter:
+ *	budget	-> Price left for the items of the conditional FP-tree
+ *
+ * Return:
+ *	0 if the conditional FP-tree is not to be built, otherwise 1.
+ */
+int FPMiner::pruneCond(int r, int suffixIncl, float suffixPrice, float *budget)
+{
+ int rr;
+
+ if (itemFlag == NULL)
+	return 1;
+ if ((!config.include.empty()) && (!suffixIncl) && ((itemFlag[largeItem1[r]] & ITEM_INCLUDE) == 0)) {
+	for (rr=0; rr < r; rr++) {
+		if ((condBase.support[rr] >= threshold) && (itemFlag[largeItem1[rr]] & ITEM_INCLUDE))
+			break;
+	}
+	if (rr == r)
+		return 0;
+ }
+ if (itemPrice != NULL)
+	*budget = config.maxPrice - suffixPrice - itemPrice[largeItem1[r]];
+
+ return 1;
+}
+/******************************************************************************************
+ * Function: condTreeBase
+ *
+ * Description:
+ *	Build the conditional pattern base of rank r of a conditional FP-tree
+ *	into condBase, as loop_same_items() does for the FP-tree.
+ *
+ * Invoked from:	
+ *	condGrowth()
+ *
+ * Functions to be invoked:
+ *	growArray()
+ *
+ * Input parameters:
+ *	tree	-> The conditional FP-tree
+ *	r	-> The rank; all the ranks on the prefix paths are below r
+ */
+template<class Rank, class Count>
+void FPMiner::condTreeBase(CondTree<Rank, Count> *tree, int r)
+{
+ CondBase *base = &condBase;
+ CondNode<Rank, Count> *node = tree->node;
+ unsigned int p, t;
+ int start, rr;
+
+ base->numPaths = 0;
+ base->numRanks = 0;
+ memset(base->support, 0, sizeof(int) * r);
+
+ for (p = tree->header[r]; p != 0; p = node[p].hlink) {
+	PREFETCH(&node[node[p].hlink]);
+	if (simTag != NULL) {
+		for (t = p; t != 0; t = node[t].parent)
+			countAccess(&node[t]);
+	}
+	start = base->numRanks;
+	for (t = node[p].parent; t != 0; t = node[t].parent) {
+		if (base->numRanks == base->sizeRanks)
+			base->ranks = (int *) growArray(base->ranks, &base->sizeRanks, sizeof(int));
+		rr = node[t].rank;
+		base->ranks[base->numRanks++] = rr;
+		base->support[rr] += node[p].count;
+	}
+	if (base->numRanks == start)
+		continue;
+
+	reverse(base->ranks + start, base->ranks + base->numRanks);
+	if (base->numPaths == base->sizePaths) {
+		rr = base->sizePaths;
+		base->pathLen = (int *) growArray(base->pathLen, &rr, sizeof(int));
+		base->pathCount = (int *) growArray(base->pathCount, &base->sizePaths, sizeof(int));
+	}
+	base->pathLen[base->numPaths] = base->numRanks - start;
+	base->pathCount[base->numPaths] = node[p].count;
+	base->numPaths++;
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: buildCondTree
+ *
+ * Description:
+ *	Build the conditional FP-tree of the pattern base in condBase: the
+ *	paths are inserted with their large ranks only, root first.
+ *	The tree has to fit in the memory budget by itself.
+ *
+ * Invoked from:	
+ *	mineCondTree()
+ *
+ * Input parameters:
+ *	numRank	-> All the ranks of the base are below numRank
+ *	budget	-> With a price limit, the price left for the items of the tree
+ *
+ * Output parameter:
+ *	tree	-> The conditional FP-tree
+ */
+template<class Rank, class Count>
+void FPMiner::buildCondTree(CondTree<Rank, Count> *tree, int numRank, float budget)
+{
+ CondBase *base = &condBase;
+ CondNode<Rank, Count> *node;
+ unsigned int cur, c;
+ int i, j, off, rr;
+
+ tree->sizeNodes = 1024;
+ tree->numNodes = 1;
+ tree->node = (CondNode<Rank, Count> *) malloc (sizeof(CondNode<Rank, Count>) * tree->sizeNodes);
+ tree->header = (unsigned int *) calloc (numRank, sizeof(unsigned int));
+ if ((tree->node == NULL) || (tree->header == NULL)) {
+	throw FPError("out of memory");
+ }
+ memset(&tree->node[0], 0, sizeof(CondNode<Rank, Count>));
+
+ for (i=0, off=0; i < base->numPaths; off += base->pathLen[i], i++) {
+	cur = 0;
+	for (j=0; j < base->pathLen[i]; j++) {
+		rr = base->ranks[off + j];
+		if ((base->support[rr] < threshold) ||
+		    ((itemPrice != NULL) && (itemPrice[largeItem1[rr]] > budget)))
+			continue;
+
+		node = tree->node;
+		for (c = node[cur].child; (c != 0) && ((int) node[c].rank != rr); c = node[c].sibling)
+			;
+		if (c == 0) {
+			if (tree->numNodes == tree->sizeNodes) {
+				if ((config.memBudget > 0) &&
+				    (sizeof(CondNode<Rank, Count>) * (tree->numNodes + 1) > (size_t) config.memBudget)) {
+					throw FPError("a conditional FP-tree exceeds the memory budget");
+				}
+				tree->node = (CondNode<Rank, Count> *) growArray(tree->node, &tree->sizeNodes, sizeof(CondNode<Rank, Count>));
+				node = tree->node;
+			}
+			c = tree->numNodes++;
+			node[c].count = 0;
+			node[c].rank = rr;
+			node[c].parent = cur;
+			node[c].child = 0;
+			node[c].sibling = node[cur].child;
+			node[cur].child = c;
+			node[c].hlink = tree->header[rr];
+			tree->header[rr] = c;
+		}
+		node[c].count += base->pathCount[i];
+		cur = c;
+	}
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: mineCondTree
+ *
+ * Description:
+ *	Build the conditional FP-tree of the pattern base in condBase and mine it.
+ *
+ * Invoked from:	
+ *	growCond()
+ *	condGrowth()
+ *
+ * Functions to be invoked:
+ *	buildCondTree(), condGrowth()
+ *
+ * Input parameters:
+ *	numRank	-> All the ranks of the base are below numRank
+ *	itemset	-> itemset[0..k-1] = Item IDs of the suffix of the tree
+ *	k	-> Size of the suffix
+ *	budget	-> With a price limit, the price left for the items of the tree
+ *
+ * The tree is freed as it goes out of scope, also when the mining throws.
+ */
+template<class Rank, class Count>
+void FPMiner::mineCondTree(int numRank, int *itemset, int k, float budget)
+{
+ CondTree<Rank, Count> tree;
+
+ buildCondTree(&tree, numRank, budget);
+
+ /* The base is free again once the conditional FP-tree is built */
+ condGrowth(&tree, numRank, itemset, k);
+
+ return;
+}
+/******************************************************************************************
+ * Function: condGrowth
+ *
+ * Description:
+ *	FP-growth of a conditional FP-tree, as fpGrowth() does for the FP-tree.
+ *	The conditional FP-trees it builds are smaller in ranks and counts,
+ *	so they keep the node layout of the tree.
+ *
+ * Invoked from:	
+ *	mineCondTree()
+ *
+ * Functions to be invoked:
+ *	condTreeBase()	-> Build the conditional pattern base
+ *	pruneCond()
+ *	addLargeItemset()
+ *	mineCondTree()
+ *
+ * Input parameters:
+ *	tree	-> The conditional FP-tree
+ *	numRank	-> All the ranks of the tree are below numRank
+ *	itemset	-> itemset[0..k-1] = Item IDs of the suffix
+ *	k	-> Size of the suffix, >= 1
+ */
+template<class Rank, class Count>
+void FPMiner::condGrowth(CondTree<Rank, Count> *tree, int numRank, int *itemset, int k)
+{
+ CondNode<Rank, Count> *node = tree->node;
+ unsigned int p;
+ float suffixPrice = 0;
+ float budget = 0;
+ int suffixIncl = 0;
+ int support;
+ int r, i;
+
+ for (i=0; (itemFlag != NULL) && (i < k); i++) {
+	suffixIncl |= itemFlag[itemset[i]] & ITEM_INCLUDE;
+	if (itemPrice != NULL)
+		suffixPrice += itemPrice[itemset[i]];
+ }
+
+ for (r=numRank-1; r >= 0; r--) {
+	if (tree->header[r] == 0)
+		continue;
+	support = 0;
+	for (p = tree->header[r]; p != 0; p = node[p].hlink)
+		support += node[p].count;
+	if (support < threshold)
+		continue;
+
+	itemset[k] = largeItem1[r];
+	addLargeItemset(itemset, k+1, support);
+	if ((k+1 >= realK) || (r == 0))
+		continue;
+
+	condTreeBase(tree, r);
+	if ((condBase.numPaths == 0) || (!pruneCond(r, suffixIncl, suffixPrice, &budget)))
+		continue;
+	mineCondTree<Rank, Count>(r, itemset, k+1, budget);
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: growCond
+ *
+ * Description:
+ *	Mine the conditional FP-tree of rank r, whose pattern base is in condBase,
+ *	in the smallest node layout that holds its ranks (< r) and its counts
+ *	(<= support); the trees grown from it fit the same layout.
+ *
+ * Invoked from:	
+ *	fpGrowth()
+ *
+ * Functions to be invoked:
+ *	mineCondTree()
+ *
+ * Input parameters:
+ *	r	-> Rank of the item
+ *	support	-> Support of the item plus the suffix
+ *	itemset	-> itemset[0..k-1] = Item IDs of the suffix of the tree
+ *	k	-> Size of the suffix
+ *	budget	-> With a price limit, the price left for the items of the tree
+ */
+void FPMiner::growCond(int r, int support, int *itemset, int k, float budget)
+{
+ if (r <= 65536) {
+	if (support <= 65535)
+		mineCondTree<unsigned short, unsigned short>(r, itemset, k, budget);
+	else
+		mineCondTree<unsigned short, unsigned int>(r, itemset, k, budget);
+ } else {
+	if (support <= 65535)
+		mineCondTree<unsigned int, unsigned short>(r, itemset, k, budget);
+	else
+		mineCondTree<unsigned int, unsigned int>(r, itemset, k, budget);
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: fpGrowth
+ *
+ * Description:
+ *	FP-growth of the paper: for each item of the FP-tree, in ascending order
+ *	of support, output the itemset of the item plus the suffix, and mine
+ *	the conditional FP-tree of the item built from its conditional pattern
+ *	base.  The FP-tree is not modified.
+ *	The conditional FP-trees are CondTrees in the node layout chosen by growCond().
+ *
+ * Invoked from:	
+ *	mine()
+ *	mineProjected()
+ *	emitWindow()
+ *	preflight()
+ *
+ * Functions to be invoked:
+ *	loop_same_items()	-> Build the conditional pattern base
+ *	pruneCond()
+ *	addLargeItemset()
+ *	growCond()
+ *
+ * Input parameters:
+ *	header	-> Header table of the FP-tree, by rank
+ *	numRank	-> All the ranks of the FP-tree are below numRank
+ *	itemset	-> itemset[0..k-1] = Item IDs of the suffix
+ *	k	-> Size of the suffix
+ *
+ * Member variables:
+ *	condBase	-> Reused for every conditional pattern base
+ *	ckptLog, ckptRank	-> If checkpointing, the items of the FP-tree of rank >= ckptRank
+ *				   are already mined, and the progress is saved between two items
+ *	itemFlag[], itemPrice[]	-> (read only) The item constraints, see pruneCond()
+ */
+void FPMiner::fpGrowth(FPTreeNode *header, int numRank, int *itemset, int k)
+{
+ CondBase *base = &condBase;
+ FPTreeNode p;
+ float suffixPrice = 0;	/* Total price of the suffix */
+ float budget = 0;	/* Price left for the items of a conditional FP-tree */
+ int suffixIncl = 0;	/* The suffix holds an item to include */
+ int support;
+ int r, i;
+
+ if (base->support == NULL) {
+	base->support = (int *) malloc (sizeof(int) * numLarge[0]);
+	if (base->support == NULL) {
+		throw FPError("out of memory");
+	}
+ }
+
+ for (i=0; (itemFlag != NULL) && (i < k); i++) {
+	suffixIncl |= itemFlag[itemset[i]] & ITEM_INCLUDE;
+	if (itemPrice != NULL)
+		suffixPrice += itemPrice[itemset[i]];
+ }
+
+ r = ((k == 0) && (ckptLog != NULL)) ? ckptRank : numRank;
+ for (r--; r >= ((k == 0) ? minRank : 0); r--) {
+	if ((k == 0) && (ckptLog != NULL) && (time(NULL) - ckptTime >= config.checkpointEvery))
+		saveProgress(r + 1);
+	if (header[r] == NULL)
+		continue;
+	support = 0;
+	for (p = header[r]; p != NULL; p = p->hlink)
+		support += p->count;
+	if (support < threshold)
+		continue;
+
+	itemset[k] = largeItem1[r];
+	if (k >= 1)
+		addLargeItemset(itemset, k+1, support);
+	if ((k+1 >= realK) || (r == 0))
+		continue;
+
+	/* Build the conditional FP-tree of the item and mine it */
+	loop_same_items(header[r], r);
+	if ((base->numPaths == 0) || (!pruneCond(r, suffixIncl, suffixPrice, &budget)))
+		continue;
+	growCond(r, support, itemset, k+1, budget);
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: init_list
+ *
+ * Description:
+ *	Prepare the work arrays of traverse_list() for the subtree rooted at p:
+ *	the residual count of each node starts at its count, the pending
+ *	children of each node at its number of children, and the leaf nodes
+ *	are put into the work queue.
+ *
+ * Invoked from:	
+ *	traverse_list()
+ *
+ * Input parameters:
+ *	p		-> Root of the subtree
+ *	queue		-> The work queue
+ *	tail		-> Number of nodes in the queue
+ *	residual	-> Residual count of each node, by node index
+ *	pending		-> Pending children of each node, by node index
+ */
+void FPMiner::init_list(FPTreeNode p, FPTreeNode *queue, int *tail, int *residual, int *pending)
+{
+	childLink link = p->children;
+
+	residual[p->id] = p->count;
+	pending[p->id] = p->numChildren;
+	if(link){
+		while(link)
+		{
+			//access the node from here: link->node
+			init_list(link->node, queue, tail, residual, pending);
+			link = link->next;
+		}
+	}
+	else if(p->parent != NULL) //find the leaf nodes
+	{
+		queue[(*tail)++] = p;
+	}
+}
+/******************************************************************************************
+ * Function: traverse_list
+ *
+ * Description:
+ *	Peel the FP-tree bottom-up, from the leaf nodes to the children of the root.
+ *	A node is dequeued once all its children are; its residual count, i.e.
+ *	its count less the counts of its children, is the number of transactions
+ *	whose path ends at the node, and combination_node() counts every
+ *	itemset on that path with it into mp.
+ *	The counts of the tree are not touched, the residual counts and the
+ *	pending children live in arrays indexed by node index, so the tree
+ *	can be mined again (e.g. at another threshold).
+ *
+ * Invoked from:	
+ *	mine()
+ *	mineProjected()
+ *
+ * Functions to be invoked:
+ *	init_list()
+ *	combination_node()
+ *
+ * Input parameters:
+ *	root	-> Root of the FP-tree
+ *	maxK	-> Upper limit of the itemset size
+ *
+ * Member variables:
+ *	mp		-> Itemsets counted
+ *	numNodes	-> Number of nodes of the FP-tree (read only)
+ */
+void FPMiner::traverse_list(FPTreeNode root, int maxK)
+{
+ vector<FPTreeNode> queue(numNodes);	/* Nodes whose children are all done, bottom-up */
+ vector<int> residual(numNodes);	/* residual[id] = count of the node not covered by its children */
+ vector<int> pending(numNodes);		/* pending[id] = children of the node not dequeued yet */
+ FPTreeNode p, parent;
+ int head, tail;
+
+ tail = 0;
+ init_list(root, &queue[0], &tail, &residual[0], &pending[0]);
+
+ for (head=0; head < tail; head++) {
+	p = queue[head];
+	parent = p->parent;
+	if (parent != root) {
+		residual[parent->id] -= p->count;
+		if (--pending[parent->id] == 0)
+			queue[tail++] = parent;
+	}
+	combination_node(p, residual[p->id], mp, maxK);
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: ItemsetOrder
+ *
+ * Description:
+ *	Order of large k-itemsets in the resulting lists:
+ *	descending order of support, ties broken by the items in ascending order.
+ */
+struct ItemsetOrder {
+	int k;		/* Size of the itemsets being compared */
+	ItemsetOrder(int size) : k(size) {}
+	bool operator()(LargeItemPtr a, LargeItemPtr b) const
+	{
+		if (a->support != b->support)
+			return a->support > b->support;
+		return lexicographical_compare(a->itemset, a->itemset + k, b->itemset, b->itemset + k);
+	}
+};
+/******************************************************************************************
+ * Function: addLargeItemset
+ *
+ * Description:
+ *	Add a large k-itemset to the front of the resulting list largeItemset[k-1].
+ *	The items are stored in ascending order of item ID.
+ *	The lists are put into ItemsetOrder by sortLargeItemsets() when mining is finished.
+ *	An itemset that breaks the item constraints is dropped, so every engine obeys them.
+ *
+ * Invoked from:	
+ *	storeLargeItemsets()
+ *	mineBitsets()
+ *
+ * Input parameters:
+ *	itemset	-> The k items, in any order
+ *	k	-> Size of the itemset
+ *	support	-> Support of the itemset
+ *
+ * Member variables:
+ *	largeItemset[]	-> largeItemset[i] = resulting list for large (i+1)-itemsets
+ *	numLarge[]	-> numLarge[i] = Number of large (i+1)-itemsets
+ */
+void FPMiner::addLargeItemset(int *itemset, int k, int support)
+{
+ LargeItemPtr aLargeItemset;
+
+ if ((itemFlag != NULL) && (!satisfies(itemset, k)))
+	return;
+
+ aLargeItemset = (LargeItemPtr) malloc (sizeof(ItemsetNode));
+ if (aLargeItemset == NULL) {
+	throw FPError("out of memory");
+ }
+ aLargeItemset->itemset = (int *) malloc (sizeof(int) * k);
+ if (aLargeItemset->itemset == NULL) {
+	free(aLargeItemset);
+	throw FPError("out of memory");
+ }
+ memcpy(aLargeItemset->itemset, itemset, sizeof(int) * k);
+ sort(aLargeItemset->itemset, aLargeItemset->itemset + k);
+ aLargeItemset->support = support;
+ aLargeItemset->next = largeItemset[k-1];
+ largeItemset[k-1] = aLargeItemset;
+ numLarge[k-1]++;
+
+ return;
+}
+/******************************************************************************************
+ * Function: sortLargeItemsets
+ *
+ * Description:
+ *	Put each resulting list largeItemset[0..realK-1] into ItemsetOrder,
+ *	so the result does not depend on the mining engine.
+ *
+ * Invoked from:	
+ *	mine()
+ *
+ * Member variables:
+ *	largeItemset[]	-> largeItemset[i] = resulting list for large (i+1)-itemsets
+ */
+void FPMiner::sortLargeItemsets()
+{
+ vector<LargeItemPtr> found;
+ LargeItemPtr aLargeItemset;
+ int i, k;
+
+ for (k=1; k <= realK; k++) {
+	found.clear();
+	for (aLargeItemset = largeItemset[k-1]; aLargeItemset != NULL; aLargeItemset = aLargeItemset->next)
+		found.push_back(aLargeItemset);
+	sort(found.begin(), found.end(), ItemsetOrder(k));
+
+	largeItemset[k-1] = NULL;
+	for (i=found.size()-1; i >= 0; i--) {
+		found[i]->next = largeItemset[k-1];
+		largeItemset[k-1] = found[i];
+	}
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: storeLargeItemsets
+ *
+ * Description:
+ *	Move the itemsets counted in mp with support >= threshold into
+ *	the resulting lists largeItemset[1..realK-1], each extended by the suffix items.
+ *	The large 1-itemsets are already stored by pass1().
+ *
+ * Invoked from:	
+ *	mine()
+ *	mineProjected()
+ *
+ * Functions to be invoked:
+ *	addLargeItemset()
+ *
+ * Input parameters:
+ *	mp		-> Itemsets (raw item ID bytes) and their supports
+ *	suffix		-> Items common to all the itemsets of mp, NULL if none
+ *	suffixLen	-> Number of suffix items
+ */
+void FPMiner::storeLargeItemsets(map<string, int> & mp, int *suffix, int suffixLen)
+{
+ vector<int> itemset;
+ map<string, int>::iterator mapit;
+ int k, n;
+
+ for (mapit = mp.begin(); mapit != mp.end(); mapit++) {
+	n = mapit->first.size() / sizeof(int);
+	k = n + suffixLen;
+	if ((k < 2) || (k > realK) || (mapit->second < threshold))
+		continue;
+	if (suffixLen == 0) {
+		addLargeItemset((int *) mapit->first.data(), k, mapit->second);
+		continue;
+	}
+	itemset.resize(k);
+	memcpy(&itemset[0], mapit->first.data(), sizeof(int) * n);
+	memcpy(&itemset[n], suffix, sizeof(int) * suffixLen);
+	addLargeItemset(&itemset[0], k, mapit->second);
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: nextRecord
+ *
+ * Description:
+ *	Read the next record of a projected DB.  A record holds the large 1-items
+ *	of a transaction, given by their positions (ranks) in largeItem1[],
+ *	in ascending order.  Projected DBs are spilled to temporary files as
+ *	<n> <rank> ... <rank> in binary.
+ *	If src is NULL the record is read from the DB by the reader, and
+ *	the large 1-items of the transaction are ranked and sorted here.
+ *
+ * Invoked from:	
+ *	mineProjected()
+ *	partitionAndMine()
+ *
+ * Functions to be invoked:
+ *	nextTrans()
+ *
+ * Input parameters:
+ *	src	-> File of a projected DB, or NULL for the DB
+ *	reader	-> Reader of the DB, used if src is NULL
+ *
+ * Output parameter:
+ *	ranks	-> The ranks of the record
+ *
+ * Return:
+ *	Number of ranks of the record, or -1 at the end.
+ */
+int FPMiner::nextRecord(FILE *src, TransReader *reader, int *ranks)
+{
+ int transSize;
+ int n, r, j;
+
+ if (src != NULL) {
+	if (fread(&n, sizeof(int), 1, src) != 1)
+		return -1;
+	if ((int) fread(ranks, sizeof(int), n, src) != n)
+		return -1;
+	return n;
+ }
+
+ if ((transSize = nextTrans(reader)) < 0)
+	return -1;
+ n = 0;
+ for (j=0; j < transSize; j++) {
+	if ((r = itemRank[reader->items[j]]) >= 0)
+		ranks[n++] = r;
+ }
+ sort(ranks, ranks + n);
+ return n;
+}
+/******************************************************************************************
+ * Function: writeRecord
+ *
+ * Description:
+ *	Append a record of n ranks to the file of a projected DB.
+ */
+static void writeRecord(FILE *dst, int *ranks, int n)
+{
+ if ((fwrite(&n, sizeof(int), 1, dst) != 1) || ((int) fwrite(ranks, sizeof(int), n, dst) != n)) {
+	throw FPError("Can't write temporary file.");
+ }
+ return;
+}
+/******************************************************************************************
+ * Function: mineProjected
+ *
+ * Description:
+ *	Mine the projected DB of a suffix itemset: the records of the transactions
+ *	containing the suffix, cut before the suffix item of highest rank.
+ *	The large itemsets found are the suffix itself and every large itemset
+ *	of the projected DB extended by the suffix.
+ *	The FP-tree of the projected DB is built within the memory budget and
+ *	mined as the initial FP-tree; if it does not fit, the projected DB
+ *	is partitioned further by partitionAndMine().
+ *
+ * Invoked from:	
+ *	partitionAndMine()
+ *	mineShard()
+ *
+ * Functions to be invoked:
+ *	nextRecord()
+ *	newRoot(), insert_tree(), destroyTree()
+ *	traverse_list(), storeLargeItemsets() or fpGrowth()
+ *	addLargeItemset()
+ *	partitionAndMine()
+ *
+ * Input parameters:
+ *	src		-> File of the projected DB
+ *	numRank		-> All the ranks of the projected DB are below numRank
+ *	suffix		-> Ranks of the suffix items
+ *	suffixLen	-> Number of suffix items
+ *	suffixSupport	-> Support of the suffix
+ */
+void FPMiner::mineProjected(FILE *src, int numRank, int *suffix, int suffixLen, int suffixSupport)
+{
+ vector<int> localSupport(numRank + 1, 0);	/* localSupport[r] = support of rank r in the projected DB */
+ vector<int> ranks(numLarge[0] + 1);		/* A record */
+ vector<int> freqItemP(numLarge[0] + 1);	/* Large items of a record */
+ vector<int> indexList(numLarge[0] + 1);	/* Ranks of the large items of a record */
+ vector<int> suffixItem(realK + 1);		/* Item IDs of the suffix */
+ vector<FPTreeNode> header(numRank + 1, (FPTreeNode) NULL);
+ TreeOwner root;
+ int count, path;
+ int n, i, j;
+
+ /* The suffix itself */
+ for (i=0; i < suffixLen; i++)
+	suffixItem[i] = largeItem1[suffix[i]];
+ if (suffixLen >= 2)
+	addLargeItemset(&suffixItem[0], suffixLen, suffixSupport);
+
+ if (suffixLen < realK) {
+	/* Count the supports of the items in the projected DB */
+	rewind(src);
+	while ((n = nextRecord(src, NULL, &ranks[0])) >= 0) {
+		for (j=0; j < n; j++)
+			localSupport[ranks[j]]++;
+	}
+
+	/* Build the FP-tree of the projected DB */
+	root.reset(newRoot());
+	treeBytes = 0;
+	treeOverflow = 0;
+	numNodes = 1;
+	rewind(src);
+	while ((!treeOverflow) && ((n = nextRecord(src, NULL, &ranks[0])) >= 0)) {
+		count = 0;
+		for (j=0; j < n; j++) {
+			if (localSupport[ranks[j]] >= threshold) {
+				freqItemP[count] = largeItem1[ranks[j]];
+				indexList[count] = ranks[j];
+				count++;
+			}
+		}
+		path = 0;
+		insert_tree(&freqItemP[0], &indexList[0], 1, 0, count, root.get(), &header[0], &path);
+	}
+
+	/* Mine it if it fits, otherwise partition it */
+	if ((!treeOverflow) && (root->children != NULL)) {
+		if (engine != ENGINE_FPTREE) {
+			fpGrowth(&header[0], numRank, &suffixItem[0], suffixLen);
+		} else {
+			mp.clear();
+			traverse_list(root.get(), realK - suffixLen);
+			storeLargeItemsets(mp, &suffixItem[0], suffixLen);
+			mp.clear();
+		}
+	}
+	root.reset();
+	if (treeOverflow)
+		partitionAndMine(src, numRank, &localSupport[0], suffix, suffixLen);
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: partitionAndMine
+ *
+ * Description:
+ *	Partition a DB that is too large for its FP-tree to fit in the memory budget
+ *	into the projected DBs of its header items, as in the disk-based
+ *	projection of the FP-growth paper, and mine each of them independently.
+ *	The projected DB of item a holds, for each transaction containing a,
+ *	its items before a.
+ *	The DB is first spilled into at most MAX_SPILL_FILES partition files,
+ *	each for a range of ranks: a transaction goes to the partition of each
+ *	range it has items in, cut after its last item in the range.  The projected
+ *	DB of each item is then cut from the partition of its range.
+ *	With spillRuns, the itemsets found are spilled to sorted runs after
+ *	each top-level projected DB, as they accumulate.
+ *
+ * Invoked from:	
+ *	mine()
+ *	mineProjected()
+ *	mineShard()
+ *
+ * Functions to be invoked:
+ *	openReader(), closeReader()
+ *	nextRecord(), writeRecord()
+ *	mineProjected()
+ *	spillItemsets()
+ *
+ * Input parameters:
+ *	src		-> File of the DB to be partitioned, or NULL for the DB itself
+ *	numRank		-> All the ranks of the DB are below numRank
+ *	localSupport	-> localSupport[r] = support of rank r in the DB
+ *	suffix		-> Ranks of the suffix items of the DB
+ *	suffixLen	-> Number of suffix items
+ */
+void FPMiner::partitionAndMine(FILE *src, int numRank, int *localSupport, int *suffix, int suffixLen)
+{
+ FileOwner part[MAX_SPILL_FILES];	/* Partition files */
+ FileOwner proj;			/* Projected DB of an item */
+ TransReader reader;
+ vector<int> ranks(numLarge[0] + 1);
+ vector<int> newSuffix(suffixLen + 1);
+ int numPart;
+ int n, m, a, b, i, j;
+
+ numPart = (numRank < MAX_SPILL_FILES) ? numRank : MAX_SPILL_FILES;
+ for (i=0; i < suffixLen; i++)
+	newSuffix[i] = suffix[i];
+
+ for (b=0; b < numPart; b++) {
+	part[b].reset(tmpfile());
+	if (part[b] == NULL) {
+		throw FPError("Can't create temporary file.");
+	}
+ }
+
+ /* Spill the DB into the partitions; rank r is in partition r * numPart / numRank */
+ if (src != NULL)
+	rewind(src);
+ else
+	openReader(&reader, config.dataFile.c_str(), &dict, config.tokenizer, config.hugePages);
+ for (i=0; (src != NULL) || (i < numTrans); i++) {
+	if ((n = nextRecord(src, &reader, &ranks[0])) < 0)
+		break;
+	m = 0;
+	for (j=0; j < n; j++) {
+		if ((ranks[j] < numRank) && (localSupport[ranks[j]] >= threshold))
+			ranks[m++] = ranks[j];
+	}
+	for (j=0; j < m; j++) {
+		b = (long) ranks[j] * numPart / numRank;
+		if ((j == m-1) || ((long) ranks[j+1] * numPart / numRank != b))
+			writeRecord(part[b].get(), &ranks[0], j+1);
+	}
+ }
+ if (src == NULL)
+	closeReader(&reader);
+
+ /* Cut the projected DB of each large item from its partition and mine it */
+ for (a = (suffixLen == 0) ? minRank : 0; a < numRank; a++) {
+	if (localSupport[a] < threshold)
+		continue;
+	b = (long) a * numPart / numRank;
+
+	proj.reset(tmpfile());
+	if (proj == NULL) {
+		throw FPError("Can't create temporary file.");
+	}
+	rewind(part[b].get());
+	while ((n = nextRecord(part[b].get(), NULL, &ranks[0])) >= 0) {
+		for (j=0; (j < n) && (ranks[j] < a); j++)
+			;
+		if ((j < n) && (ranks[j] == a))
+			writeRecord(proj.get(), &ranks[0], j);
+	}
+
+	newSuffix[suffixLen] = a;
+	mineProjected(proj.get(), a, &newSuffix[0], suffixLen + 1, localSupport[a]);
+	proj.reset();
+	if (suffixLen == 0)
+		spillItemsets(0);
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: mineShard
+ *
+ * Description:
+ *	The work of a worker process of mineShards(): mine the large itemsets
+ *	(k >= 2) whose last item has a rank in [lo, hi) from the projected DB
+ *	of the shard, and write them to the result file of the shard, each size
+ *	in ItemsetOrder, as <k> <support> <k items> in binary.
+ *	The shard is mined as a projected DB: by FP-growth on its FP-tree, or
+ *	partitioned further if the tree exceeds the memory budget or the
+ *	engine is the leaf-peeling one.
+ *
+ * Invoked from:	
+ *	workShard(), in a worker process
+ *
+ * Functions to be invoked:
+ *	mineProjected(), partitionAndMine()
+ *	sortLargeItemsets()
+ *
+ * Input parameters:
+ *	src		-> File of the projected DB of the shard
+ *	lo, hi		-> Range of the ranks of the shard
+ *	resultName	-> Result file of the shard
+ *
+ * Member variables:
+ *	minRank	-> Set to lo
+ */
+void FPMiner::mineShard(FILE *src, int lo, int hi, const char *resultName)
+{
+ LargeItemPtr aLargeItemset;
+ vector<int> localSupport(hi + 1, 0);
+ vector<int> ranks(numLarge[0] + 1);
+ FILE *fp;
+ int rec[2];
+ int n, j, k;
+
+ minRank = lo;
+ if (engine != ENGINE_FPTREE)
+	mineProjected(src, hi, NULL, 0, 0);
+ else {
+	/* Leaf-peeling mines a whole tree: mine the projected DB of each item instead */
+	rewind(src);
+	while ((n = nextRecord(src, NULL, &ranks[0])) >= 0) {
+		for (j=0; j < n; j++)
+			localSupport[ranks[j]]++;
+	}
+	partitionAndMine(src, hi, &localSupport[0], NULL, 0);
+ }
+ sortLargeItemsets();
+
+ if ((fp = fopen(resultName, "wb")) == NULL) {
+        throw FPError(string("Can't open shard file, ") + resultName + ".");
+ }
+ for (k=2; k <= realK; k++) {
+	for (aLargeItemset = largeItemset[k-1]; aLargeItemset != NULL; aLargeItemset = aLargeItemset->next) {
+		rec[0] = k;
+		rec[1] = aLargeItemset->support;
+		fwrite(rec, sizeof(int), 2, fp);
+		fwrite(aLargeItemset->itemset, sizeof(int), k, fp);
+	}
+ }
+ if ((ferror(fp)) | (fclose(fp) != 0)) {
+        throw FPError(string("Can't write shard file, ") + resultName + ".");
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: nextShardItemset
+ *
+ * Description:
+ *	Read the next itemset of the result file of a shard into a new
+ *	node of a resulting list.
+ *
+ * Invoked from:	
+ *	mineShards()
+ *
+ * Input parameters:
+ *	fp	-> Result file of the shard
+ *
+ * Output parameter:
+ *	k	-> Size of the itemset
+ *
+ * Return:
+ *	The itemset, or NULL at the end of the file.
+ */
+static LargeItemPtr nextShardItemset(FILE *fp, int *k)
+{
+ LargeItemPtr aLargeItemset;
+ int rec[2];
+
+ if (fread(rec, sizeof(int), 2, fp) != 2)
+	return NULL;
+ aLargeItemset = (LargeItemPtr) malloc (sizeof(ItemsetNode));
+ if (aLargeItemset == NULL) {
+	throw FPError("out of memory");
+ }
+ aLargeItemset->itemset = (int *) malloc (sizeof(int) * rec[0]);
+ if (aLargeItemset->itemset == NULL) {
+	free(aLargeItemset);
+	throw FPError("out of memory");
+ }
+ if ((int) fread(aLargeItemset->itemset, sizeof(int), rec[0], fp) != rec[0]) {
+	free(aLargeItemset->itemset);
+	free(aLargeItemset);
+	throw FPError("shard result file is truncated");
+ }
+ aLargeItemset->support = rec[1];
+ aLargeItemset->next = NULL;
+ *k = rec[0];
+ return aLargeItemset;
+}
+/******************************************************************************************
+ * Function: saveShardState
+ *
+ * Description:
+ *	Write what a shard worker needs of this miner to mine its projected DB:
+ *	the engine, limits and thresholds, the large 1-items by rank, the ranks
+ *	of the items and the item constraints.
+ *
+ * Invoked from:	
+ *	mineShards()
+ *
+ * Input parameters:
+ *	name	-> The state file
+ */
+void FPMiner::saveShardState(const char *name)
+{
+ FILE *fp;
+ int head[8];
+ int n;
+
+ if ((fp = fopen(name, "wb")) == NULL) {
+        throw FPError(string("Can't open shard file, ") + name + ".");
+ }
+ fwrite("FPTSHRD1", 1, 8, fp);
+ head[0] = engine;
+ head[1] = realK;
+ head[2] = threshold;
+ head[3] = numItem;
+ head[4] = numLarge[0];
+ head[5] = (itemFlag != NULL);
+ head[6] = (itemPrice != NULL);
+ head[7] = config.verbose;
+ fwrite(head, sizeof(int), 8, fp);
+ fwrite(&config.memBudget, sizeof(long), 1, fp);
+ fwrite(&config.maxPrice, sizeof(float), 1, fp);
+ n = config.include.size();
+ fwrite(&n, sizeof(int), 1, fp);
+ fwrite(config.include.data(), 1, n, fp);
+ fwrite(largeItem1, sizeof(int), numLarge[0], fp);
+ fwrite(itemRank, sizeof(int), numItem, fp);
+ if (itemFlag != NULL)
+	fwrite(itemFlag, sizeof(unsigned char), numItem + 1, fp);
+ if (itemPrice != NULL)
+	fwrite(itemPrice, sizeof(float), numItem + 1, fp);
+ if ((ferror(fp)) | (fclose(fp) != 0)) {
+        throw FPError(string("Can't write shard file, ") + name + ".");
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: loadShardState
+ *
+ * Description:
+ *	Set up the miner of a shard worker from the file of saveShardState().
+ *
+ * Invoked from:	
+ *	workShard()
+ *
+ * Input parameters:
+ *	name	-> The state file
+ */
+void FPMiner::loadShardState(const char *name)
+{
+ FileOwner fp(fopen(name, "rb"));
+ char magic[8];
+ int head[8];
+ int n, ok;
+
+ if (fp == NULL) {
+        throw FPError(string("Can't open shard file, ") + name + ".");
+ }
+ ok = (fread(magic, 1, 8, fp.get()) == 8) && (memcmp(magic, "FPTSHRD1", 8) == 0) &&
+	(fread(head, sizeof(int), 8, fp.get()) == 8) &&
+	(fread(&config.memBudget, sizeof(long), 1, fp.get()) == 1) &&
+	(fread(&config.maxPrice, sizeof(float), 1, fp.get()) == 1) &&
+	(fread(&n, sizeof(int), 1, fp.get()) == 1) && (n >= 0);
+ if (!ok) {
+        throw FPError(string("Not a shard file, ") + name + ".");
+ }
+ engine = head[0];
+ realK = head[1];
+ threshold = treeThreshold = head[2];
+ numItem = head[3];
+ config.verbose = head[7];
+ config.include.resize(n);
+ largeItemset = (LargeItemPtr *) calloc (realK, sizeof(LargeItemPtr));
+ numLarge = (int *) calloc (realK, sizeof(int));
+ largeItem1 = (int *) malloc (sizeof(int) * (head[4] + 1));
+ itemRank = (int *) malloc (sizeof(int) * (numItem + 1));
+ if ((largeItemset == NULL) || (numLarge == NULL) || (largeItem1 == NULL) || (itemRank == NULL)) {
+	throw FPError("out of memory");
+ }
+ numLarge[0] = head[4];
+ if (head[5]) {
+	if ((itemFlag = (unsigned char *) malloc (numItem + 1)) == NULL) {
+		throw FPError("out of memory");
+	}
+ }
+ if (head[6]) {
+	if ((itemPrice = (float *) malloc (sizeof(float) * (numItem + 1))) == NULL) {
+		throw FPError("out of memory");
+	}
+ }
+ ok = ((n == 0) || (fread(&config.include[0], 1, n, fp.get()) == (size_t) n)) &&
+	(fread(largeItem1, sizeof(int), numLarge[0], fp.get()) == (size_t) numLarge[0]) &&
+	(fread(itemRank, sizeof(int), numItem, fp.get()) == (size_t) numItem) &&
+	((itemFlag == NULL) || (fread(itemFlag, 1, numItem + 1, fp.get()) == (size_t) numItem + 1)) &&
+	((itemPrice == NULL) || (fread(itemPrice, sizeof(float), numItem + 1, fp.get()) == (size_t) numItem + 1));
+ if (!ok) {
+        throw FPError(string("shard file is truncated, ") + name + ".");
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: workShard
+ *
+ * Description:
+ *	The work of a shard worker process, the fpt program run by mineShards():
+ *	set up the miner from the state file, bind it to its NUMA node, and
+ *	mine the projected DB of the shard into its result file.
+ *
+ * Invoked from:	
+ *	main(), in a worker process
+ *
+ * Functions to be invoked:
+ *	loadShardState()
+ *	numaNodes(), numaBind()
+ *	mineShard()
+ *
+ * Input parameters:
+ *	stateName	-> The state file of saveShardState()
+ *	dbName		-> File of the projected DB of the shard
+ *	lo, hi		-> Range of the ranks of the shard
+ *	resultName	-> Result file of the shard
+ *	node		-> NUMA node to bind the worker to, -1 = not bound
+ */
+void FPMiner::workShard(const char *stateName, const char *dbName, int lo, int hi, const char *resultName, int node)
+{
+ FileOwner src;
+#ifdef __linux__
+ vector<cpu_set_t> cpus;
+
+ if ((node >= 0) && (numaNodes(cpus) > node))
+	numaBind(node, &cpus[node]);
+#endif
+
+ loadShardState(stateName);
+ src.reset(fopen(dbName, "rb"));
+ if (src == NULL) {
+        throw FPError(string("Can't open shard file, ") + dbName + ".");
+ }
+ mineShard(src.get(), lo, hi, resultName);
+
+ return;
+}
+/******************************************************************************************
+ * Function: mineShards
+ *
+ * Description:
+ *	Mine the DB in config.shards worker processes.  The ranks of the large
+ *	1-items are cut into as many ranges, of about the same work each
+ *	(support times rank, the size of the projected DBs of the items).
+ *	One scan of the DB writes the projected DB of each range to a file
+ *	next to the result file: a transaction goes to the shard of each range
+ *	it has items in, cut after its last item in the range.  A worker is
+ *	started for each shard, and their sorted result files are merged into
+ *	the resulting lists, which are then in ItemsetOrder.  With spillRuns
+ *	(OUT_ITEMS), the result files are instead read one after the other
+ *	and spilled to sorted runs as they come, for writeSortedItemsets().
+ *	The files are removed at the end.
+ *	On a NUMA system, unless config.numa is 0, the workers are bound to the
+ *	nodes in turn, and so allocate their FP-trees on their own node.
+ *
+ *	A worker is a new run of the fpt program (workShard()), started by
+ *	posix_spawn() with the state of the miner in a file: a forked copy of
+ *	a host with other threads could deadlock on a lock held by one of them.
+ *	So the shards are CLI-only; compiled as a library, the DB is mined in
+ *	this process by partitionAndMine() instead.
+ *
+ * Invoked from:	
+ *	mine()
+ *
+ * Functions to be invoked:
+ *	openReader(), nextRecord(), writeRecord(), closeReader()
+ *	numaNodes()
+ *	saveShardState()
+ *	partitionAndMine()
+ *	nextShardItemset(), spillItemsets()
+ *
+ * Member variables:
+ *	largeItemset[], numLarge[]	-> The large k-itemsets of the shards, k >= 2
+ */
+void FPMiner::mineShards()
+{
+#ifdef _WIN32
+ throw FPError("sharded mining needs posix_spawn()");
+#else
+ int numShard = (config.shards < numLarge[0]) ? config.shards : numLarge[0];
+ vector<int> first(numShard + 1);	/* Shard s holds the ranks [first[s], first[s+1]) */
+ vector<int> shardOf(numLarge[0]);	/* shardOf[r] = shard of rank r */
+ vector<int> ranks(numLarge[0] + 1);
+ vector<string> dbName(numShard), resultName(numShard);
+ vector<FileOwner> shard(numShard);
+ vector<pid_t> worker(numShard);
+ vector<FileOwner> result(numShard);
+ vector<LargeItemPtr> head(numShard);	/* head[s] = next itemset of shard s, NULL at the end */
+ vector<int> headK(numShard);		/* Its size */
+ vector<string> args;			/* Command line of a worker */
+ vector<char *> argv;
+ string stateName = config.outFile + ".shards";
+ LargeItemPtr *tail;
+ TransReader reader;
+ double total, work;
+ char suffix[32];
+ int status, best;
+ int n, s, r, j, k;
+ int nodes = 0;		/* NUMA nodes the workers are bound to, 0 = not bound */
+#ifdef __linux__
+ vector<cpu_set_t> cpus;
+
+ if ((config.numa) && ((nodes = numaNodes(cpus)) == 1))
+	nodes = 0;
+#endif
+
+ if (shardProgram == NULL) {
+	/* No fpt program to run the workers */
+	report("shards are CLI-only, mining the DB in this process\n");
+	partitionAndMine(NULL, numLarge[0], support1, NULL, 0);
+	return;
+ }
+
+ /* Cut the ranks into ranges of about the same work */
+ total = 0;
+ for (r=0; r < numLarge[0]; r++)
+	total += (double) support1[r] * (r + 1);
+ first[0] = 0;
+ work = 0;
+ for (r=0, s=0; r < numLarge[0]; r++) {
+	work += (double) support1[r] * (r + 1);
+	shardOf[r] = s;
+	if ((work >= total * (s + 1) / numShard) && (s < numShard - 1))
+		first[++s] = r + 1;
+ }
+ numShard = s + 1;
+ first[numShard] = numLarge[0];
+
+ /* Write the projected DB of each shard */
+ for (s=0; s < numShard; s++) {
+	sprintf(suffix, ".shard%d", s);
+	dbName[s] = config.outFile + suffix;
+	resultName[s] = dbName[s] + ".out";
+	shard[s].reset(fopen(dbName[s].c_str(), "w+b"));
+	if (shard[s] == NULL) {
+	        throw FPError(string("Can't open shard file, ") + dbName[s] + ".");
+	}
+ }
+ openReader(&reader, config.dataFile.c_str(), &dict, config.tokenizer, config.hugePages);
+ for (j=0; j < numTrans; j++) {
+	if ((n = nextRecord(NULL, &reader, &ranks[0])) < 0)
+		break;
+	for (k=0; k < n; k++) {
+		s = shardOf[ranks[k]];
+		if ((k == n-1) || (shardOf[ranks[k+1]] != s))
+			writeRecord(shard[s].get(), &ranks[0], k+1);
+	}
+ }
+ closeReader(&reader);
+ for (s=0; s < numShard; s++)
+	fflush(shard[s].get());
+
+ /* Start the workers: fpt -shard <state> <db> <lo> <hi> <result> <node> */
+ saveShardState(stateName.c_str());
+ fflush(stdout);
+ fflush(stderr);
+ for (s=0; s < numShard; s++) {
+	args.assign(1, shardProgram);
+	args.push_back("-shard");
+	args.push_back(stateName);
+	args.push_back(dbName[s]);
+	args.push_back(to_string(first[s]));
+	args.push_back(to_string(first[s+1]));
+	args.push_back(resultName[s]);
+	args.push_back(to_string((nodes > 0) ? s % nodes : -1));
+	argv.clear();
+	for (j=0; j < (int) args.size(); j++)
+		argv.push_back(&args[j][0]);
+	argv.push_back(NULL);
+	if (posix_spawnp(&worker[s], shardProgram, NULL, NULL, &argv[0], environ) != 0) {
+		for (j=0; j < s; j++)
+			waitpid(worker[j], &status, 0);
+		for (j=0; j < numShard; j++) {
+			shard[j].reset();
+			remove(dbName[j].c_str());
+			remove(resultName[j].c_str());
+		}
+		remove(stateName.c_str());
+		throw FPError(string("Can't start a shard worker, ") + shardProgram + ".");
+	}
+	if (nodes > 0)
+		report("shard %d: ranks %d-%d, worker %d on NUMA node %d\n", s, first[s], first[s+1] - 1, (int) worker[s], s % nodes);
+	else
+		report("shard %d: ranks %d-%d, worker %d\n", s, first[s], first[s+1] - 1, (int) worker[s]);
+ }
+ best = 0;
+ for (s=0; s < numShard; s++) {
+	if ((waitpid(worker[s], &status, 0) < 0) || (!WIFEXITED(status)) || (WEXITSTATUS(status) != 0))
+		best = 1;
+	shard[s].reset();
+	remove(dbName[s].c_str());
+ }
+ remove(stateName.c_str());
+ if (best) {
+	for (s=0; s < numShard; s++)
+		remove(resultName[s].c_str());
+	throw FPError("a shard worker failed");
+ }
+
+ /* Merge the sorted results of the shards, size by size */
+ try {
+	for (s=0; s < numShard; s++) {
+		result[s].reset(fopen(resultName[s].c_str(), "rb"));
+		if (result[s] == NULL) {
+		        throw FPError(string("Can't open shard file, ") + resultName[s] + ".");
+		}
+		if (spillRuns) {
+			/* Spill the results of the shard as they come, in runs of config.sortRun */
+			while ((head[s] = nextShardItemset(result[s].get(), &headK[s])) != NULL) {
+				k = headK[s];
+				head[s]->next = largeItemset[k-1];
+				largeItemset[k-1] = head[s];
+				numLarge[k-1]++;
+				head[s] = NULL;
+				spillItemsets(0);
+			}
+			result[s].reset();
+			remove(resultName[s].c_str());
+			continue;
+		}
+		head[s] = nextShardItemset(result[s].get(), &headK[s]);
+	}
+	for (k=2; (!spillRuns) && (k <= realK); k++) {
+		tail = &largeItemset[k-1];
+		while (*tail != NULL)
+			tail = &(*tail)->next;
+		for (;;) {
+			/* The head of size k first in ItemsetOrder */
+			best = -1;
+			for (s=0; s < numShard; s++) {
+				if ((head[s] != NULL) && (headK[s] == k) && ((best < 0) || (ItemsetOrder(k)(head[s], head[best]))))
+					best = s;
+			}
+			if (best < 0)
+				break;
+			*tail = head[best];
+			tail = &head[best]->next;
+			numLarge[k-1]++;
+			head[best] = NULL;	/* Linked, so not freed if the next read throws */
+			head[best] = nextShardItemset(result[best].get(), &headK[best]);
+		}
+	}
+ } catch (...) {
+	/* The heads not merged yet are freed on the way out */
+	for (s=0; s < numShard; s++) {
+		if (head[s] != NULL) {
+			free(head[s]->itemset);
+			free(head[s]);
+		}
+		result[s].reset();
+		remove(resultName[s].c_str());
+	}
+	throw;
+ }
+ for (s=0; s < numShard; s++) {
+	result[s].reset();
+	remove(resultName[s].c_str());
+ }
+#endif
+
+ return;
+}
+/******************************************************************************************
+ * Function: writeLargeItemsets
+ *
+ * Description:
+ *	Write all the large itemsets to the result file, outFile.
+ *	One itemset per line, smaller itemsets first:
+ *		<item> <item> ... (<support>)
+ *	Each size in ItemsetOrder, or in ascending order of the item IDs
+ *	if config.outOrder is OUT_ITEMS.
+ *
+ * Invoked from:	
+ *	writeResults()
+ *
+ * Functions to be invoked:
+ *	writeItemsets(), writeSortedItemsets()
+ *
+ * Member variables (read only):
+ *	largeItemset[], numLarge[], realK, config.outFile
+ */
+void FPMiner::writeLargeItemsets()
+{
+ FileOwner fp(fopen(config.outFile.c_str(), "w"));
+
+ if (fp == NULL) {
+        throw FPError(string("Can't open result file, ") + config.outFile + ".");
+ }
+ if (config.outOrder == OUT_ITEMS)
+	writeSortedItemsets(fp.get());
+ else
+	writeItemsets(fp.get());
+ fp.reset();
+
+ return;
+}
+/******************************************************************************************
+ * Function: itemKeys
+ *
+ * Description:
+ *	Map the dense items of an itemset back to the item IDs of the DB,
+ *	in ascending order.
+ *
+ * Input parameters:
+ *	itemset	-> k dense items
+ *	k	-> Size of the itemset
+ *
+ * Output parameter:
+ *	keys	-> The k item IDs
+ */
+void FPMiner::itemKeys(const int *itemset, int k, long long *keys)
+{
+ int i;
+
+ for (i=0; i < k; i++)
+	keys[i] = dict.key[itemset[i]];
+ sort(keys, keys + k);
+ return;
+}
+/******************************************************************************************
+ * Function: writeItemsets
+ *
+ * Description:
+ *	Write the large itemsets, one per line: <item> <item> ... (<support>)
+ *	The lists being in ItemsetOrder, an itemset found twice comes twice
+ *	in a row, and is written once.
+ *
+ * Invoked from:	
+ *	writeLargeItemsets()
+ *	emitWindow()
+ *
+ * Input parameters:
+ *	fp	-> The result file
+ */
+void FPMiner::writeItemsets(FILE *fp)
+{
+ LargeItemPtr aLargeItemset, prev;
+ vector<long long> keys(realK);
+ int i, k;
+
+ for (k=1; k <= realK; k++) {
+	if (numLargeItemsets(k) > 0)
+		report("No. of large %d-itemsets = %d\n", k, numLargeItemsets(k));
+	prev = NULL;
+	for (aLargeItemset = largeItemset[k-1]; aLargeItemset != NULL; prev = aLargeItemset, aLargeItemset = aLargeItemset->next) {
+		if ((prev != NULL) && (prev->support == aLargeItemset->support) &&
+		    (memcmp(prev->itemset, aLargeItemset->itemset, sizeof(int) * k) == 0))
+			continue;
+		itemKeys(aLargeItemset->itemset, k, &keys[0]);
+		for (i=0; i < k; i++)
+			fprintf(fp, "%lld ", keys[i]);
+		fprintf(fp, "(%d)\n", aLargeItemset->support);
+	}
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: KeyOrder
+ *
+ * Description:
+ *	Order of the records of a sorted run, each the k item IDs of an itemset
+ *	in ascending order and its support: by the item IDs.  RunOrder is the
+ *	same order of the heads of the runs being merged, for a heap.
+ */
+struct KeyOrder {
+	const long long *rec;	/* The records, k+1 numbers each */
+	int k;			/* Size of the itemsets */
+	KeyOrder(const long long *r, int size) : rec(r), k(size) {}
+	bool operator()(int a, int b) const
+	{
+		return lexicographical_compare(rec + (size_t) a * (k+1), rec + (size_t) a * (k+1) + k,
+					       rec + (size_t) b * (k+1), rec + (size_t) b * (k+1) + k);
+	}
+};
+struct RunOrder {
+	const vector<const long long *> *head;	/* head[r] = first record left of run r */
+	int k;
+	RunOrder(const vector<const long long *> *h, int size) : head(h), k(size) {}
+	bool operator()(int a, int b) const
+	{
+		/* The least head on the top of the heap */
+		return lexicographical_compare((*head)[b], (*head)[b] + k, (*head)[a], (*head)[a] + k);
+	}
+};
+#define MERGE_FAN	64	/* Max. number of sorted runs merged at a time */
+/*
+ * A run being merged: its records [next, end) of a run file.
+ */
+typedef struct Runpart {
+	FILE *fp;
+	long next, end;
+} RunPart;
+/*
+ * Receiver of the records of a merge pass: append them to a run file.
+ */
+static void appendRecord(const long long *itemset, int k, int support, void *user)
+{
+ RunFile *run = (RunFile *) user;
+ long long s = support;
+
+ if ((fwrite(itemset, sizeof(long long), k, run->fp) != (size_t) k) || (fwrite(&s, sizeof(long long), 1, run->fp) != 1)) {
+	throw FPError("Can't write temporary file.");
+ }
+ run->bound.back()++;
+ return;
+}
+/*
+ * Receiver of the records of the last merge pass: write them to the result
+ * file, as writeItemsets() does.
+ */
+static void printItemset(const long long *itemset, int k, int support, void *user)
+{
+ FILE *fp = (FILE *) user;
+ int i;
+
+ for (i=0; i < k; i++)
+	fprintf(fp, "%lld ", itemset[i]);
+ fprintf(fp, "(%d)\n", support);
+ return;
+}
+/*
+ * Read the next records of a run being merged into its buffer, at most
+ * bufRecs of them; returns the number read, 0 at the end of the run.
+ */
+static int refillRun(RunPart *run, long long *buf, int k, int bufRecs)
+{
+ size_t recBytes = sizeof(long long) * (k+1);
+ int n;
+
+ n = (run->end - run->next < bufRecs) ? run->end - run->next : bufRecs;
+ if (n == 0)
+	return 0;
+ if ((fseek(run->fp, run->next * (long) recBytes, SEEK_SET) != 0) ||
+     (fread(buf, recBytes, n, run->fp) != (size_t) n)) {
+	throw FPError("Can't read temporary file.");
+ }
+ run->next += n;
+ return n;
+}
+/******************************************************************************************
+ * Function: mergeRuns
+ *
+ * Description:
+ *	Merge sorted runs into one sequence, by a k-way merge on a heap of their
+ *	first records, and hand each record to the callback; a record equal to
+ *	the one before it (an itemset found twice) is dropped.  Each run is read
+ *	bufRecs records at a time.
+ *
+ * Invoked from:	
+ *	mergeItemsets()
+ *
+ * Functions to be invoked:
+ *	refillRun()
+ *
+ * Input parameters:
+ *	runs		-> The runs
+ *	k		-> Size of the itemsets
+ *	bufRecs		-> Records of a run in memory at a time
+ *	callback	-> Receiver of the records
+ *	user		-> Passed on to the callback
+ */
+static void mergeRuns(vector<RunPart> &runs, int k, int bufRecs, ItemsetCallback callback, void *user)
+{
+ vector<long long> buf(runs.size() * bufRecs * (k+1));
+ vector<const long long *> head(runs.size());
+ vector<int> left(runs.size());		/* Records of run r left in buf[] */
+ vector<long long> last;		/* Record handed out last */
+ priority_queue<int, vector<int>, RunOrder> heap(RunOrder(&head, k));
+ int r;
+
+ for (r=0; r < (int) runs.size(); r++) {
+	head[r] = &buf[(size_t) r * bufRecs * (k+1)];
+	if ((left[r] = refillRun(&runs[r], &buf[(size_t) r * bufRecs * (k+1)], k, bufRecs)) > 0)
+		heap.push(r);
+ }
+ while (!heap.empty()) {
+	/* Hand out the least head, and go on with the rest of its run */
+	r = heap.top();
+	heap.pop();
+	if ((last.empty()) || (!equal(head[r], head[r] + k, last.begin()))) {
+		last.assign(head[r], head[r] + k);
+		callback(head[r], k, (int) head[r][k], user);
+	}
+	head[r] += k+1;
+	if (--left[r] == 0) {
+		head[r] = &buf[(size_t) r * bufRecs * (k+1)];
+		left[r] = refillRun(&runs[r], &buf[(size_t) r * bufRecs * (k+1)], k, bufRecs);
+	}
+	if (left[r] > 0)
+		heap.push(r);
+ }
+ return;
+}
+/******************************************************************************************
+ * Function: cutRun
+ *
+ * Description:
+ *	Take the next run of at most max itemsets of size k from a list:
+ *	the records of their k item IDs in ascending order and their support,
+ *	and the order of the records by item IDs.
+ *
+ * Invoked from:	
+ *	spillRun()
+ *	writeSortedItemsets()
+ *
+ * Functions to be invoked:
+ *	itemKeys()
+ *
+ * Input parameters:
+ *	list	-> The itemsets left, moved past the ones taken
+ *	k	-> Size of the itemsets
+ *	max	-> Max. size of the run
+ *
+ * Output parameters:
+ *	rec	-> The records, k+1 numbers each
+ *	order	-> The records by item IDs
+ *
+ * Return:
+ *	The number of itemsets taken.
+ */
+int FPMiner::cutRun(LargeItemPtr *list, int k, int max, vector<long long> &rec, vector<int> &order)
+{
+ LargeItemPtr aLargeItemset;
+ int n, i;
+
+ for (n=0, aLargeItemset = *list; (n < max) && (aLargeItemset != NULL); n++, aLargeItemset = aLargeItemset->next)
+	;
+ rec.resize((size_t) n * (k+1));
+ for (i=0; i < n; i++, *list = (*list)->next) {
+	itemKeys((*list)->itemset, k, &rec[(size_t) i * (k+1)]);
+	rec[(size_t) i * (k+1) + k] = (*list)->support;
+ }
+ order.resize(n);
+ for (i=0; i < n; i++)
+	order[i] = i;
+ sort(order.begin(), order.end(), KeyOrder(rec.data(), k));
+ return n;
+}
+/******************************************************************************************
+ * Function: spillRun
+ *
+ * Description:
+ *	Sort the next run of at most max itemsets of a list and append it to a run file.
+ *
+ * Invoked from:	
+ *	spillItemsets()
+ *	mergeItemsets()
+ *
+ * Functions to be invoked:
+ *	cutRun()
+ *
+ * Input parameters:
+ *	run	-> The run file, created if it has no file yet
+ *	list	-> The itemsets left, moved past the ones spilled
+ *	k	-> Size of the itemsets
+ *	max	-> Max. size of the run
+ */
+void FPMiner::spillRun(RunFile *run, LargeItemPtr *list, int k, int max)
+{
+ vector<long long> rec;
+ vector<int> order;
+ int n, i;
+
+ if (run->fp == NULL) {
+	if ((run->fp = tmpfile()) == NULL) {
+		throw FPError("Can't create temporary file.");
+	}
+	run->bound.assign(1, 0);
+ }
+ n = cutRun(list, k, max, rec, order);
+ fseek(run->fp, 0, SEEK_END);
+ for (i=0; i < n; i++) {
+	if (fwrite(&rec[(size_t) order[i] * (k+1)], sizeof(long long), k+1, run->fp) != (size_t) k+1) {
+		throw FPError("Can't write temporary file.");
+	}
+ }
+ run->bound.push_back(run->bound.back() + n);
+ return;
+}
+/******************************************************************************************
+ * Function: spillItemsets
+ *
+ * Description:
+ *	With spillRuns, move the large k-itemsets (k >= 2) in the lists to
+ *	sorted runs in itemRuns[k-1], once config.sortRun of them are in memory
+ *	(or at once if all is set), so that what a shard or a partition found
+ *	is spilled as it comes and the lists stay small.
+ *
+ * Invoked from:	
+ *	partitionAndMine()
+ *	mineShards()
+ *
+ * Functions to be invoked:
+ *	spillRun()
+ *
+ * Input parameters:
+ *	all	-> Spill whatever is in the lists
+ *
+ * Member variables:
+ *	largeItemset[]	-> Emptied for k >= 2; numLarge[] still counts the itemsets spilled
+ *	itemRuns[], numSpilled
+ */
+void FPMiner::spillItemsets(int all)
+{
+ LargeItemPtr aLargeItemset, next;
+ int sortRun = (config.sortRun > 0) ? config.sortRun : 1;
+ long held = 0;
+ int k;
+
+ if (!spillRuns)
+	return;
+ for (k=2; k <= realK; k++)
+	held += numLarge[k-1];
+ held -= numSpilled;
+ if ((held == 0) || ((!all) && (held < sortRun)))
+	return;
+
+ if (itemRuns == NULL)
+	itemRuns = new RunFile[realK];
+ for (k=2; k <= realK; k++) {
+	aLargeItemset = largeItemset[k-1];
+	while (aLargeItemset != NULL)
+		spillRun(&itemRuns[k-1], &aLargeItemset, k, sortRun);
+	for (aLargeItemset = largeItemset[k-1]; aLargeItemset != NULL; aLargeItemset = next) {
+		next = aLargeItemset->next;
+		free(aLargeItemset->itemset);
+		free(aLargeItemset);
+	}
+	largeItemset[k-1] = NULL;
+ }
+ numSpilled += held;
+ return;
+}
+/******************************************************************************************
+ * Function: mergeItemsets
+ *
+ * Description:
+ *	Hand the large k-itemsets to the callback in ascending order of the
+ *	item IDs, an itemset found twice once, with bounded memory: the runs
+ *	spilled while mining (itemRuns[k-1]) and the list, cut into sorted runs
+ *	of config.sortRun itemsets in a temporary file, are merged MERGE_FAN
+ *	runs at a time, pass after pass, into a temporary file until
+ *	MERGE_FAN runs or fewer are left, which are merged to the callback.
+ *	The list and itemRuns are left as they are.
+ *
+ * Invoked from:	
+ *	writeSortedItemsets()
+ *	streamResults()
+ *
+ * Functions to be invoked:
+ *	spillRun(), mergeRuns()
+ *
+ * Input parameters:
+ *	k		-> Size of the itemsets
+ *	callback	-> Receiver of the itemsets
+ *	user		-> Passed on to the callback
+ */
+void FPMiner::mergeItemsets(int k, ItemsetCallback callback, void *user)
+{
+ unique_ptr<RunFile> listRuns(new RunFile), pass[2];
+ vector<RunPart> runs, group;
+ LargeItemPtr aLargeItemset = largeItemset[k-1];
+ RunFile *src[2] = {(itemRuns != NULL) ? &itemRuns[k-1] : NULL, listRuns.get()};
+ int sortRun = (config.sortRun > 0) ? config.sortRun : 1;
+ int bufRecs = (sortRun / MERGE_FAN > 16) ? sortRun / MERGE_FAN : 16;
+ int p = 0;
+ size_t g, i, r;
+
+ while (aLargeItemset != NULL)
+	spillRun(listRuns.get(), &aLargeItemset, k, sortRun);
+ for (i=0; i < 2; i++) {
+	for (r=0; (src[i] != NULL) && (src[i]->fp != NULL) && (r + 1 < src[i]->bound.size()); r++) {
+		RunPart part = {src[i]->fp, src[i]->bound[r], src[i]->bound[r+1]};
+		runs.push_back(part);
+	}
+ }
+
+ /* Merge passes, each into a new run file, until one more pass is the last */
+ while (runs.size() > MERGE_FAN) {
+	pass[p].reset(new RunFile);
+	if ((pass[p]->fp = tmpfile()) == NULL) {
+		throw FPError("Can't create temporary file.");
+	}
+	pass[p]->bound.assign(1, 0);
+	for (g=0; g < runs.size(); g += MERGE_FAN) {
+		group.assign(runs.begin() + g, runs.begin() + ((g + MERGE_FAN < runs.size()) ? g + MERGE_FAN : runs.size()));
+		pass[p]->bound.push_back(pass[p]->bound.back());
+		fseek(pass[p]->fp, 0, SEEK_END);
+		mergeRuns(group, k, bufRecs, appendRecord, pass[p].get());
+	}
+	fflush(pass[p]->fp);
+	runs.clear();
+	for (r=0; r + 1 < pass[p]->bound.size(); r++) {
+		RunPart part = {pass[p]->fp, pass[p]->bound[r], pass[p]->bound[r+1]};
+		runs.push_back(part);
+	}
+	p = 1 - p;
+	pass[p].reset();	/* The pass before the last one is merged */
+	listRuns.reset();
+ }
+ mergeRuns(runs, k, bufRecs, callback, user);
+
+ return;
+}
+/******************************************************************************************
+ * Function: writeSortedItemsets
+ *
+ * Description:
+ *	Write the large itemsets as writeItemsets() does, but each size in
+ *	ascending order of the item IDs, with bounded memory: a size of at most
+ *	config.sortRun itemsets, none spilled, is sorted in memory and written
+ *	directly, and any other is merged from sorted runs by mergeItemsets().
+ *	An itemset found twice is written once.
+ *
+ * Invoked from:	
+ *	writeLargeItemsets()
+ *
+ * Functions to be invoked:
+ *	cutRun(), mergeItemsets()
+ *
+ * Input parameters:
+ *	fp	-> The result file
+ */
+void FPMiner::writeSortedItemsets(FILE *fp)
+{
+ LargeItemPtr aLargeItemset;
+ vector<long long> rec;
+ vector<int> order;
+ int sortRun = (config.sortRun > 0) ? config.sortRun : 1;
+ const long long *r, *last;
+ int n, i, k;
+
+ for (k=1; k <= realK; k++) {
+	if (numLargeItemsets(k) > 0)
+		report("No. of large %d-itemsets = %d\n", k, numLargeItemsets(k));
+	if (((itemRuns != NULL) && (itemRuns[k-1].fp != NULL)) || (numLargeItemsets(k) > sortRun)) {
+		mergeItemsets(k, printItemset, fp);
+		continue;
+	}
+
+	/* All the itemsets of the size in one run */
+	aLargeItemset = largeItemset[k-1];
+	n = cutRun(&aLargeItemset, k, sortRun, rec, order);
+	for (i=0, last = NULL; i < n; last = r, i++) {
+		r = &rec[(size_t) order[i] * (k+1)];
+		if ((last == NULL) || (!equal(r, r + k, last)))
+			printItemset(r, k, (int) r[k], fp);
+	}
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: hashItemset
+ *
+ * Description:
+ *	FNV-1a hash of the k items of an itemset.
+ */
+static unsigned int hashItemset(int *itemset, int k)
+{
+ unsigned int h = 2166136261u;
+ int i;
+
+ for (i=0; i < k; i++) {
+	h ^= (unsigned int) itemset[i];
+	h *= 16777619u;
+ }
+ return h;
+}
+/******************************************************************************************
+ * Function: buildItemsetIndex
+ *
+ * Description:
+ *	Build the hash index itemsetIndex[k-1] over the large k-itemsets, k = 1 to realK,
+ *	so that the support of any large itemset can be looked up in O(1).
+ *
+ * Invoked from:	
+ *	genRules()
+ *
+ * Functions to be invoked:
+ *	hashItemset()
+ *
+ * Member variables:
+ *	itemsetIndex[]	-> itemsetIndex[k-1] = hash index over large k-itemsets
+ */
+void FPMiner::buildItemsetIndex()
+{
+ LargeItemPtr aLargeItemset;
+ unsigned int h;
+ int k;
+
+ itemsetIndex = (ItemsetIndex *) malloc (sizeof(ItemsetIndex) * realK);
+ if (itemsetIndex == NULL) {
+	throw FPError("out of memory");
+ }
+
+ for (k=1; k <= realK; k++) {
+	itemsetIndex[k-1].size = 1;
+	while (itemsetIndex[k-1].size < 2 * numLarge[k-1])
+		itemsetIndex[k-1].size <<= 1;
+	itemsetIndex[k-1].slot = (LargeItemPtr *) calloc (itemsetIndex[k-1].size, sizeof(LargeItemPtr));
+	if (itemsetIndex[k-1].slot == NULL) {
+		throw FPError("out of memory");
+	}
+
+	for (aLargeItemset = largeItemset[k-1]; aLargeItemset != NULL; aLargeItemset = aLargeItemset->next) {
+		h = hashItemset(aLargeItemset->itemset, k) & (itemsetIndex[k-1].size - 1);
+		while (itemsetIndex[k-1].slot[h] != NULL)
+			h = (h + 1) & (itemsetIndex[k-1].size - 1);
+		itemsetIndex[k-1].slot[h] = aLargeItemset;
+	}
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: findItemset
+ *
+ * Description:
+ *	Look up a large k-itemset in the hash index.
+ *
+ * Input parameters:
+ *	itemset	-> k items in ascending order
+ *	k	-> Size of the itemset
+ *
+ * Return:
+ *	The large itemset, or NULL if it is not large.
+ */
+LargeItemPtr FPMiner::findItemset(int *itemset, int k)
+{
+ ItemsetIndex *index = &(itemsetIndex[k-1]);
+ unsigned int h = hashItemset(itemset, k) & (index->size - 1);
+
+ while (index->slot[h] != NULL) {
+	if (memcmp(index->slot[h]->itemset, itemset, sizeof(int) * k) == 0)
+		return index->slot[h];
+	h = (h + 1) & (index->size - 1);
+ }
+ return NULL;
+}
+/******************************************************************************************
+ * Function: genRulesWorker
+ *
+ * Description:
+ *	Generate the rules X => Y of a share of the large itemsets.
+ *	Itemsets are handed out in chunks of RULE_CHUNK, and the rules of chunk c
+ *	are written to out[c], so the rule file keeps the order of the itemsets
+ *	whatever the number of threads is.
+ *	For a large itemset I and every non-empty proper subset X of I, Y = I - X:
+ *		confidence = sup(I) / sup(X)
+ *		lift       = confidence / (sup(Y) / numTrans)
+ *
+ * Invoked from:	
+ *	genRules()
+ *
+ * Functions to be invoked:
+ *	findItemset()
+ *
+ * Input parameters:
+ *	sets		-> Large itemsets of size >= 2
+ *	sizes		-> sizes[i] = size of sets[i]
+ *	out		-> out[c] = rules of chunk c
+ *	nextChunk	-> Next chunk to be handed out
+ *	numRules	-> Number of rules generated so far
+ */
+#define RULE_CHUNK 64
+void FPMiner::genRulesWorker(vector<LargeItemPtr> *sets, vector<int> *sizes, vector<string> *out,
+			atomic<int> *nextChunk, atomic<long> *numRules)
+{
+ int x[32], y[32];	/* Antecedent and consequent of a rule */
+ char line[64];
+ LargeItemPtr aSubset;
+ float conf, lift;
+ int supX, supY;
+ int numChunk = (sets->size() + RULE_CHUNK - 1) / RULE_CHUNK;
+ int c, i, j, k, kx, ky;
+ unsigned int mask;
+
+ while ((c = (*nextChunk)++) < numChunk) {
+	string &buf = (*out)[c];
+	for (i=c * RULE_CHUNK; (i < (c + 1) * RULE_CHUNK) && (i < (int) sets->size()); i++) {
+		k = (*sizes)[i];
+		if (k > 31)
+			continue;
+
+		for (mask=1; mask < (1u << k) - 1; mask++) {
+			kx = ky = 0;
+			for (j=0; j < k; j++) {
+				if (mask & (1u << j))
+					x[kx++] = (*sets)[i]->itemset[j];
+				else
+					y[ky++] = (*sets)[i]->itemset[j];
+			}
+
+			if ((aSubset = findItemset(x, kx)) == NULL)
+				continue;
+			supX = aSubset->support;
+			conf = (float) (*sets)[i]->support / supX;
+			if (conf < config.minConf)
+				continue;
+
+			if ((aSubset = findItemset(y, ky)) == NULL)
+				continue;
+			supY = aSubset->support;
+			lift = conf * numTrans / supY;
+			if (lift < config.minLift)
+				continue;
+
+			for (j=0; j < kx; j++) {
+				sprintf(line, "%lld ", dict.key[x[j]]);
+				buf.append(line);
+			}
+			buf.append("=>");
+			for (j=0; j < ky; j++) {
+				sprintf(line, " %lld", dict.key[y[j]]);
+				buf.append(line);
+			}
+			sprintf(line, " (%d, %.4f, %.4f)\n", (*sets)[i]->support, conf, lift);
+			buf.append(line);
+			(*numRules)++;
+		}
+	}
+ }
+ return;
+}
+/******************************************************************************************
+ * Function: genRules
+ *
+ * Description:
+ *	Generate the association rules of all the large itemsets with
+ *	confidence >= minConf and lift >= minLift into ruleFile.
+ *	One rule per line:
+ *		<item> ... => <item> ... (<support>, <confidence>, <lift>)
+ *	The supports of the subsets are looked up in the hash index of the itemsets,
+ *	and the itemsets are shared among numThreads threads.
+ *	Nothing is done if no ruleFile is given in the config. file.
+ *
+ * Invoked from:	
+ *	writeResults()
+ *
+ * Functions to be invoked:
+ *	buildItemsetIndex()
+ *	genRulesWorker()
+ *
+ * Member variables (read only):
+ *	largeItemset[], numLarge[], realK, config.ruleFile, config.numThreads
+ */
+void FPMiner::genRules()
+{
+ vector<LargeItemPtr> sets;
+ vector<int> sizes;
+ vector<string> out;
+ vector<thread> workers;
+ atomic<int> nextChunk(0);
+ atomic<long> numRules(0);
+ LargeItemPtr aLargeItemset;
+ FILE *fp;
+ int nThreads;
+ int i, k;
+
+ if (config.ruleFile.empty()) return;
+
+ buildItemsetIndex();
+
+ for (k=2; k <= realK; k++) {
+	for (aLargeItemset = largeItemset[k-1]; aLargeItemset != NULL; aLargeItemset = aLargeItemset->next) {
+		sets.push_back(aLargeItemset);
+		sizes.push_back(k);
+	}
+ }
+ out.resize((sets.size() + RULE_CHUNK - 1) / RULE_CHUNK);
+
+ nThreads = config.numThreads;
+ if (nThreads <= 0)
+	nThreads = thread::hardware_concurrency();
+ if (nThreads <= 0)
+	nThreads = 1;
+
+ for (i=0; i < nThreads; i++)
+	workers.push_back(thread(&FPMiner::genRulesWorker, this, &sets, &sizes, &out, &nextChunk, &numRules));
+ for (i=0; i < nThreads; i++)
+	workers[i].join();
+
+ if ((fp = fopen(config.ruleFile.c_str(), "w")) == NULL) {
+        throw FPError(string("Can't open rule file, ") + config.ruleFile + ".");
+ }
+ for (i=0; i < (int) out.size(); i++)
+	fwrite(out[i].data(), 1, out[i].size(), fp);
+ fclose(fp);
+
+ report("No. of rules = %ld (%d threads)\n", (long) numRules, nThreads);
+ return;
+}
+/******************************************************************************************
+ * Function: popcount64
+ *
+ * Description:
+ *	Number of bits set in a 64-bit word.
+ */
+#if defined(__GNUC__)
+#define popcount64(x) __builtin_popcountll(x)
+#else
+inline int popcount64(unsigned long long x)
+{
+ x = x - ((x >> 1) & 0x5555555555555555ULL);
+ x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+ x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+ return (int) ((x * 0x0101010101010101ULL) >> 56);
+}
+#endif
+/******************************************************************************************
+ * Function: andCountScalar
+ *
+ * Description:
+ *	out[] = a[] AND b[], and return the number of bits set in out[],
+ *	one word at a time.
+ *
+ * Invoked from:	
+ *	andCount()
+ *	andCountAVX2()
+ *
+ * Input Parameters:
+ *	a, b	-> The two bitsets
+ *	n	-> Number of 64-bit words of a bitset
+ *
+ * Output Parameter:
+ *	out	-> The intersection of the two bitsets
+ */
+static int andCountScalar(const unsigned long long *a, const unsigned long long *b, unsigned long long *out, int n)
+{
+ int support = 0;
+ int i;
+
+ for (i=0; i < n; i++) {
+	out[i] = a[i] & b[i];
+	support += popcount64(out[i]);
+ }
+ return support;
+}
+#ifdef KERNEL_SIMD
+/******************************************************************************************
+ * Function: andCountAVX2
+ *
+ * Description:
+ *	The AVX2 andCountScalar(): 4 words are processed at a time and counted
+ *	with the nibble lookup popcount (vpshufb), accumulated by vpsadbw;
+ *	the remaining words are left to andCountScalar().
+ */
+__attribute__((target("avx2")))
+static int andCountAVX2(const unsigned long long *a, const unsigned long long *b, unsigned long long *out, int n)
+{
+ const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+					 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+ const __m256i low4 = _mm256_set1_epi8(0x0f);
+ __m256i acc = _mm256_setzero_si256();
+ __m256i v, cnt;
+ int i;
+
+ for (i=0; i + 4 <= n; i += 4) {
+	v = _mm256_and_si256(_mm256_loadu_si256((const __m256i *) (a + i)),
+			     _mm256_loadu_si256((const __m256i *) (b + i)));
+	_mm256_storeu_si256((__m256i *) (out + i), v);
+	cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low4)),
+			      _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low4)));
+	acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+ }
+ return (int) (_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1)
+		+ _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3))
+	+ andCountScalar(a + i, b + i, out + i, n - i);
+}
+#endif
+/******************************************************************************************
+ * Function: andCount
+ *
+ * Description:
+ *	out[] = a[] AND b[], and return the number of bits set in out[]:
+ *	by andCountAVX2() if the CPU has AVX2, else by andCountScalar().
+ *	The kernel is chosen at the first call.
+ *
+ * Invoked from:	
+ *	extendBitset()
+ *
+ * Input Parameters:
+ *	a, b	-> The two bitsets
+ *	n	-> Number of 64-bit words of a bitset
+ *
+ * Output Parameter:
+ *	out	-> The intersection of the two bitsets
+ */
+typedef int (*AndCounter)(const unsigned long long *a, const unsigned long long *b, unsigned long long *out, int n);
+
+static AndCounter chooseAndCount()
+{
+#ifdef KERNEL_SIMD
+ __builtin_cpu_init();
+ if (__builtin_cpu_supports("avx2"))
+	return andCountAVX2;
+#endif
+ return andCountScalar;
+}
+
+static int andCount(const unsigned long long *a, const unsigned long long *b, unsigned long long *out, int n)
+{
+ static const AndCounter counter = chooseAndCount();	/* Initialized once, even by several miners */
+
+ return counter(a, b, out, n);
+}
+/******************************************************************************************
+ * Function: buildBitsets
+ *
+ * Description:
+ *	Scan the DB and build the bitset of the transactions containing
+ *	each large 1-item: bit t of tidBits[r] is set if transaction t contains
+ *	the large 1-item largeItem1[r].
+ *	The bitsets are one big block, on huge pages if config.hugePages lets them.
+ *
+ * Invoked from:	
+ *	build()
+ *
+ * Functions to be invoked:
+ *	bigAlloc()
+ *	openReader(), nextTrans(), closeReader()
+ *
+ * Member variables:
+ *	tidBits[]	-> tidBits[r * numWords ...] = bitset of large 1-item r
+ *	bitBlock	-> Its memory
+ *	numWords	-> Number of 64-bit words of a bitset
+ *
+ * Member variables (read only):
+ *	itemRank[], numLarge[], numTrans, config.dataFile
+ */
+void FPMiner::buildBitsets()
+{
+ TransReader reader;
+ int transSize;
+ int r;
+ int i, j;
+
+ numWords = (numTrans + 63) / 64;
+ tidBits = (unsigned long long *) bigAlloc(&bitBlock, (size_t) numLarge[0] * numWords * sizeof(unsigned long long), config.hugePages);
+ if (tidBits == NULL) {
+	throw FPError("out of memory");
+ }
+ report("bitsets: %.1f MB on %s pages\n", bitBlock.bytes / 1048576.0, pagesName[bitBlock.pages]);
+
+ openReader(&reader, config.dataFile.c_str(), &dict, config.tokenizer, config.hugePages);
+ for (i=0; i < numTrans; i++) {
+	if ((transSize = nextTrans(&reader)) < 0)
+		break;
+	for (j=0; j < transSize; j++) {
+		if ((r = itemRank[reader.items[j]]) >= 0)
+			tidBits[(size_t) r * numWords + i / 64] |= 1ULL << (i % 64);
+	}
+ }
+ closeReader(&reader);
+
+ return;
+}
+/******************************************************************************************
+ * Function: extendBitset
+ *
+ * Description:
+ *	Depth-first extension of a large k-itemset by the large 1-items after
+ *	its last one in the large 1-item order.  The support of each extension
+ *	is the number of bits set in the AND of the two bitsets.
+ *
+ * Invoked from:	
+ *	mineBitsets()
+ *	extendBitset()
+ *
+ * Functions to be invoked:
+ *	andCount()
+ *	addLargeItemset()
+ *	extendBitset()
+ *
+ * Input Parameters:
+ *	prefix	-> Bitset of the k-itemset
+ *	last	-> Position in largeItem1[] of the last item of the k-itemset
+ *	k	-> Size of the itemset
+ *	itemset	-> itemset[0..k-1] = the k-itemset
+ *	stack	-> stack[(k-1) * numWords ...] = bitset of the (k+1)-itemsets being extended
+ */
+void FPMiner::extendBitset(const unsigned long long *prefix, int last, int k, int *itemset, unsigned long long *stack)
+{
+ unsigned long long *out = stack + (size_t) (k-1) * numWords;
+ int support;
+ int j;
+
+ for (j=last+1; j < numLarge[0]; j++) {
+	support = andCount(prefix, &(tidBits[(size_t) j * numWords]), out, numWords);
+	if (support < threshold)
+		continue;
+
+	itemset[k] = largeItem1[j];
+	addLargeItemset(itemset, k+1, support);
+	if (k+1 < realK)
+		extendBitset(out, j, k+1, itemset, stack);
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: mineBitsets
+ *
+ * Description:
+ *	Mine the large k-itemsets (k = 2 to realK) from the bitsets of the large 1-items.
+ *
+ * Invoked from:	
+ *	mine()
+ *
+ * Functions to be invoked:
+ *	extendBitset()
+ */
+void FPMiner::mineBitsets()
+{
+ vector<unsigned long long> stack;	/* One bitset for each itemset size being extended */
+ vector<int> itemset;
+ int i;
+
+ if (realK < 2) return;
+
+ stack.resize((size_t) numWords * (realK - 1) + 1);
+ itemset.resize(realK);
+
+ for (i=0; i < numLarge[0]; i++) {
+	itemset[0] = largeItem1[i];
+	extendBitset(&(tidBits[(size_t) i * numWords]), i, 1, &itemset[0], &stack[0]);
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: initShuffleTable
+ *
+ * Description:
+ *	shuffleTable[mask] = pshufb control moving the 32-bit lanes set in the 4-bit
+ *	mask to the front of a vector, used to store the matching tids of a block.
+ *
+ * Invoked from:	
+ *	mineEclat()
+ */
+#ifdef KERNEL_SIMD
+static unsigned char shuffleTable[16][16];
+static void fillShuffleTable()
+{
+ int mask, lane, pos, b;
+
+ for (mask=0; mask < 16; mask++) {
+	memset(shuffleTable[mask], 0x80, 16);
+	pos = 0;
+	for (lane=0; lane < 4; lane++) {
+		if (mask & (1 << lane)) {
+			for (b=0; b < 4; b++)
+				shuffleTable[mask][pos * 4 + b] = lane * 4 + b;
+			pos++;
+		}
+	}
+ }
+ return;
+}
+static void initShuffleTable()
+{
+ static once_flag filled;	/* Several miners may run in one process */
+
+ call_once(filled, fillShuffleTable);
+ return;
+}
+/******************************************************************************************
+ * Function: matchBlock
+ *
+ * Description:
+ *	Compare a block of 4 tids of a[] with a block of 4 tids of b[]
+ *	(all 16 pairs, by comparing with the 4 rotations of the b block).
+ *
+ * Return:
+ *	4-bit mask of the tids of the a block found in the b block.
+ */
+__attribute__((target("ssse3")))
+static inline int matchBlock(const int *a, const int *b)
+{
+ __m128i va = _mm_loadu_si128((const __m128i *) a);
+ __m128i vb = _mm_loadu_si128((const __m128i *) b);
+ __m128i m;
+
+ m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(va, vb),
+			       _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+		  _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+			       _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+ return _mm_movemask_ps(_mm_castsi128_ps(m));
+}
+#else
+static void initShuffleTable()
+{
+ return;
+}
+#endif
+/******************************************************************************************
+ * Function: intersectScalar
+ *
+ * Description:
+ *	out[] = a[] intersect b[] for two sorted tid-lists, by a scalar merge.
+ *
+ * Invoked from:	
+ *	intersectTids()
+ *	intersectSSSE3()
+ *
+ * Return:
+ *	Number of tids in out[].
+ */
+static int intersectScalar(const int *a, int na, const int *b, int nb, int *out)
+{
+ int i = 0, j = 0, k = 0;
+
+ while ((i < na) && (j < nb)) {
+	if (a[i] < b[j])
+		i++;
+	else if (a[i] > b[j])
+		j++;
+	else {
+		out[k++] = a[i];
+		i++;
+		j++;
+	}
+ }
+ return k;
+}
+/******************************************************************************************
+ * Function: diffScalar
+ *
+ * Description:
+ *	out[] = a[] - b[] for two sorted tid-lists, by a scalar merge.
+ *	The tids of the first 4 of a[] set in matched are known to be in b[].
+ *
+ * Invoked from:	
+ *	diffTids()
+ *	diffSSSE3()
+ *
+ * Return:
+ *	Number of tids in out[].
+ */
+static int diffScalar(const int *a, int na, const int *b, int nb, int *out, int matched)
+{
+ int i, j = 0, k = 0;
+
+ for (i=0; i < na; i++) {
+	if ((i < 4) && (matched & (1 << i)))
+		continue;
+	while ((j < nb) && (b[j] < a[i]))
+		j++;
+	if ((j < nb) && (b[j] == a[i]))
+		continue;
+	out[k++] = a[i];
+ }
+ return k;
+}
+#ifdef KERNEL_SIMD
+/******************************************************************************************
+ * Function: intersectSSSE3
+ *
+ * Description:
+ *	The SSSE3 intersectScalar(): blocks of 4 tids are compared by matchBlock()
+ *	and the matching tids of the a block are stored with one pshufb; the
+ *	block with the smaller last tid is advanced.  The rest is left to
+ *	intersectScalar().
+ */
+__attribute__((target("ssse3")))
+static int intersectSSSE3(const int *a, int na, const int *b, int nb, int *out)
+{
+ int i = 0, j = 0, k = 0;
+ int mask;
+
+ while ((i + 4 <= na) && (j + 4 <= nb)) {
+	mask = matchBlock(a + i, b + j);
+	_mm_storeu_si128((__m128i *) (out + k),
+			 _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (a + i)),
+					  _mm_loadu_si128((const __m128i *) shuffleTable[mask])));
+	k += popcount64(mask);
+	if (a[i+3] < b[j+3])
+		i += 4;
+	else if (a[i+3] > b[j+3])
+		j += 4;
+	else {
+		i += 4;
+		j += 4;
+	}
+ }
+ return k + intersectScalar(a + i, na - i, b + j, nb - j, out + k);
+}
+/******************************************************************************************
+ * Function: diffSSSE3
+ *
+ * Description:
+ *	The SSSE3 diffScalar(), same block scheme as intersectSSSE3(): the tids
+ *	of the current a block matched by any b block are remembered in a mask,
+ *	and the unmatched ones are stored when the a block is passed.  The rest
+ *	is left to diffScalar().
+ */
+__attribute__((target("ssse3")))
+static int diffSSSE3(const int *a, int na, const int *b, int nb, int *out)
+{
+ int i = 0, j = 0, k = 0;
+ int matched = 0;	/* Tids of the a block starting at i matched so far */
+ int mask;
+
+ while ((i + 4 <= na) && (j + 4 <= nb)) {
+	matched |= matchBlock(a + i, b + j);
+	if (a[i+3] <= b[j+3]) {
+		mask = ~matched & 0xf;
+		_mm_storeu_si128((__m128i *) (out + k),
+				 _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (a + i)),
+						  _mm_loadu_si128((const __m128i *) shuffleTable[mask])));
+		k += popcount64(mask);
+		matched = 0;
+		if (a[i+3] == b[j+3])
+			j += 4;
+		i += 4;
+	} else
+		j += 4;
+ }
+ return k + diffScalar(a + i, na - i, b + j, nb - j, out + k, matched);
+}
+#endif
+/******************************************************************************************
+ * Function: intersectTids, diffTids
+ *
+ * Description:
+ *	out[] = a[] intersect b[], and out[] = a[] - b[], for two sorted tid-lists:
+ *	by the SSSE3 kernels if the CPU has SSSE3, else by the scalar ones.
+ *	The kernels are chosen at the first call.
+ *	out[] must have room for min(na, nb) + 4 tids (intersectTids()),
+ *	or na + 4 tids (diffTids()).
+ *
+ * Invoked from:	
+ *	extendEclat()
+ *
+ * Return:
+ *	Number of tids in out[].
+ */
+typedef int (*TidMerger)(const int *a, int na, const int *b, int nb, int *out);
+
+static int diffNone(const int *a, int na, const int *b, int nb, int *out)
+{
+ return diffScalar(a, na, b, nb, out, 0);
+}
+
+#ifdef KERNEL_SIMD
+static int hasSSSE3()
+{
+ __builtin_cpu_init();
+ return __builtin_cpu_supports("ssse3");
+}
+#endif
+
+static int intersectTids(const int *a, int na, const int *b, int nb, int *out)
+{
+#ifdef KERNEL_SIMD
+ static const TidMerger merger = hasSSSE3() ? intersectSSSE3 : intersectScalar;	/* Initialized once */
+#else
+ static const TidMerger merger = intersectScalar;
+#endif
+
+ return merger(a, na, b, nb, out);
+}
+
+static int diffTids(const int *a, int na, const int *b, int nb, int *out)
+{
+#ifdef KERNEL_SIMD
+ static const TidMerger merger = hasSSSE3() ? diffSSSE3 : diffNone;	/* Initialized once */
+#else
+ static const TidMerger merger = diffNone;
+#endif
+
+ return merger(a, na, b, nb, out);
+}
+/******************************************************************************************
+ * Function: extendEclat
+ *
+ * Description:
+ *	Depth-first mining of an equivalence class: the itemsets sharing the
+ *	same (k-1)-prefix, each with its tid-list (Eclat) or diffset (dEclat).
+ *	Member i is joined with every member j after it:
+ *	  Eclat:	t(PXY) = t(PX) intersect t(PY)
+ *	  dEclat:	d(XY)  = t(X) - t(Y)	for a class of tid-lists
+ *			d(PXY) = d(PY) - d(PX)	for a class of diffsets
+ *			sup(PXY) = sup(PX) - |d(PXY)|
+ *
+ * Invoked from:	
+ *	mineEclat()
+ *	extendEclat()
+ *
+ * Functions to be invoked:
+ *	intersectTids(), diffTids()
+ *	addLargeItemset()
+ *	extendEclat()
+ *
+ * Input Parameters:
+ *	cls	-> Members of the class
+ *	n	-> Number of members
+ *	k	-> Size of the itemsets of the class
+ *	itemset	-> itemset[0..k-2] = prefix of the class
+ *	isDiff	-> The members hold diffsets instead of tid-lists
+ */
+void FPMiner::extendEclat(TidList *cls, int n, int k, int *itemset, int isDiff)
+{
+ vector<TidList> next;	/* The class of prefix itemset + cls[i].item */
+ int m;
+ int i, j;
+
+ for (i=0; i < n; i++) {
+	itemset[k-1] = cls[i].item;
+	if (k >= 2)
+		addLargeItemset(itemset, k, cls[i].support);
+	if (k >= realK)
+		continue;
+
+	next.resize(n - i);
+	m = 0;
+	try {
+		for (j=i+1; j < n; j++) {
+			next[m].tids = (int *) malloc (sizeof(int) * ((isDiff ? cls[j].size : cls[i].size) + 4));
+			if (next[m].tids == NULL) {
+				throw FPError("out of memory");
+			}
+			next[m].item = cls[j].item;
+
+			if (engine == ENGINE_ECLAT) {
+				next[m].size = intersectTids(cls[i].tids, cls[i].size, cls[j].tids, cls[j].size, next[m].tids);
+				next[m].support = next[m].size;
+			} else if (!isDiff) {
+				next[m].size = diffTids(cls[i].tids, cls[i].size, cls[j].tids, cls[j].size, next[m].tids);
+				next[m].support = cls[i].support - next[m].size;
+			} else {
+				next[m].size = diffTids(cls[j].tids, cls[j].size, cls[i].tids, cls[i].size, next[m].tids);
+				next[m].support = cls[i].support - next[m].size;
+			}
+
+			if (next[m].support >= threshold)
+				m++;
+			else
+				free(next[m].tids);
+		}
+
+		extendEclat(&next[0], m, k+1, itemset, engine == ENGINE_DECLAT);
+	} catch (...) {
+		/* The tid-lists of the class are freed on the way out */
+		for (j=0; j < m; j++)
+			free(next[j].tids);
+		throw;
+	}
+
+	for (j=0; j < m; j++)
+		free(next[j].tids);
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: buildTidLists
+ *
+ * Description:
+ *	Scan the DB once to build the sorted tid-list of each large 1-item,
+ *	in the large 1-item order of pass1().
+ *
+ * Invoked from:	
+ *	build()
+ *
+ * Functions to be invoked:
+ *	openReader(), nextTrans(), closeReader()
+ *	bigAlloc()
+ *
+ * Member variables:
+ *	tidLists	-> The tid-lists of the large 1-items
+ *	tidBlock	-> Their tids, one big block
+ *	itemRank[], largeItem1[], support1[], numLarge[], numTrans, config.dataFile (read only)
+ */
+void FPMiner::buildTidLists()
+{
+ TransReader reader;
+ size_t numTids;
+ int *tids;
+ int transSize;
+ int r;
+ int i, j;
+
+ tidLists = (TidList *) calloc (numLarge[0], sizeof(TidList));
+ if (tidLists == NULL) {
+	throw FPError("out of memory");
+ }
+ for (i=0, numTids=0; i < numLarge[0]; i++)
+	numTids += support1[i] + 4;
+ tids = (int *) bigAlloc(&tidBlock, sizeof(int) * numTids, config.hugePages);
+ if (tids == NULL) {
+	throw FPError("out of memory");
+ }
+ report("tid-lists: %.1f MB on %s pages\n", tidBlock.bytes / 1048576.0, pagesName[tidBlock.pages]);
+ for (i=0; i < numLarge[0]; i++) {
+	tidLists[i].item = largeItem1[i];
+	tidLists[i].support = support1[i];
+	tidLists[i].size = 0;
+	tidLists[i].tids = tids;
+	tids += support1[i] + 4;
+ }
+
+ /* Tids are appended in scan order, so each tid-list is sorted */
+ openReader(&reader, config.dataFile.c_str(), &dict, config.tokenizer, config.hugePages);
+ for (i=0; i < numTrans; i++) {
+	if ((transSize = nextTrans(&reader)) < 0)
+		break;
+	for (j=0; j < transSize; j++) {
+		if ((r = itemRank[reader.items[j]]) >= 0)
+			tidLists[r].tids[tidLists[r].size++] = i;
+	}
+ }
+ closeReader(&reader);
+
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: mineEclat
+ *
+ * Description:
+ *	Mine the large k-itemsets (k = 2 to realK) with the vertical layout:
+ *	mine the class of all the large 1-items by extendEclat() with
+ *	tid-lists (engine eclat) or diffsets (engine declat).
+ *
+ * Invoked from:	
+ *	mine()
+ *
+ * Functions to be invoked:
+ *	initShuffleTable()
+ *	extendEclat()
+ *
+ * Member variables (read only):
+ *	tidLists, numLarge[]
+ */
+void FPMiner::mineEclat()
+{
+ vector<int> itemset(realK + 1);
+
+ initShuffleTable();
+
+ extendEclat(tidLists, numLarge[0], 1, &itemset[0], 0);
+
+ return;
+}
+/******************************************************************************************
+ * Function: newPatRoot
+ *
+ * Description:
+ *	Create the root of a Patricia FP-tree, a node with an empty run.
+ *
+ * Invoked from:	
+ *	buildPatTree()
+ *	patGrowth()
+ */
+static PatTreeNode newPatRoot()
+{
+ PatTreeNode root;
+
+ root = (PatTreeNode) malloc (sizeof(PatNode));
+ if (root == NULL) {
+	throw FPError("out of memory");
+ }
+ root->numItems = 0;
+ root->count = 0;
+ root->parent = NULL;
+ root->children = NULL;
+ root->sibling = NULL;
+ root->links = NULL;
+ root->items = NULL;
+
+ return root;
+}
+/******************************************************************************************
+ * Function: newPatNode
+ *
+ * Description:
+ *	Create a node for the run of items ranks[0..n-1] under parent,
+ *	and put a header table entry for each item in front of its chain.
+ *	The memory is accounted in treeBytes like newTreeNode() does.
+ *
+ * Invoked from:	
+ *	insertPatTree()
+ *
+ * Input parameters:
+ *	parent	-> Parent of the node
+ *	ranks	-> The items of the run, ascending
+ *	n	-> Length of the run
+ *	count	-> Count of the run
+ *	header	-> Header table of the tree
+ *
+ * Member variables:
+ *	treeBytes, treeOverflow, numNodes
+ *
+ * Return:
+ *	The new node, or NULL if the tree does not fit.
+ */
+PatTreeNode FPMiner::newPatNode(PatTreeNode parent, int *ranks, int n, int count, PatLink *header)
+{
+ PatTreeNode node;
+ PatLink entry;
+ size_t size;
+ int i;
+
+ size = sizeof(PatNode) + n * (sizeof(PatLink) + sizeof(PatLinkNode) + sizeof(int));
+ if ((config.memBudget > 0) && (treeBytes + (long) size > config.memBudget)) {
+	treeOverflow = 1;
+	return NULL;
+ }
+ if ((node = (PatTreeNode) malloc (size)) == NULL) {
+	treeOverflow = 1;
+	return NULL;
+ }
+ treeBytes += size;
+ numNodes++;
+
+ node->numItems = n;
+ node->count = count;
+ node->parent = parent;
+ node->children = NULL;
+ node->sibling = parent->children;
+ parent->children = node;
+ node->links = (PatLink *) (node + 1);
+ entry = (PatLink) (node->links + n);
+ node->items = (int *) (entry + n);
+
+ for (i=0; i < n; i++, entry++) {
+	node->items[i] = ranks[i];
+	node->links[i] = entry;
+	entry->node = node;
+	entry->pos = i;
+	entry->next = header[ranks[i]];
+	header[ranks[i]] = entry;
+ }
+
+ return node;
+}
+/******************************************************************************************
+ * Function: splitPatNode
+ *
+ * Description:
+ *	Split the run of a node after its first d items: the node keeps
+ *	the first d items, and a new child takes the rest of the run together
+ *	with the children of the node.  The header table entries of the items
+ *	moved stay where they are in their chains and are pointed at the new child.
+ *
+ * Invoked from:	
+ *	insertPatTree()
+ *
+ * Input parameters:
+ *	node	-> The node
+ *	d	-> Number of items kept, 0 < d < node->numItems
+ *
+ * Member variables:
+ *	treeBytes, treeOverflow, numNodes
+ */
+void FPMiner::splitPatNode(PatTreeNode node, int d)
+{
+ PatTreeNode lower;
+ PatTreeNode child;
+ size_t size;
+ int n = node->numItems - d;
+ int i;
+
+ size = sizeof(PatNode) + n * (sizeof(PatLink) + sizeof(int));
+ if ((config.memBudget > 0) && (treeBytes + (long) size > config.memBudget)) {
+	treeOverflow = 1;
+	return;
+ }
+ if ((lower = (PatTreeNode) malloc (size)) == NULL) {
+	treeOverflow = 1;
+	return;
+ }
+ treeBytes += size;
+ numNodes++;
+
+ lower->numItems = n;
+ lower->count = node->count;
+ lower->parent = node;
+ lower->children = node->children;
+ lower->sibling = NULL;
+ lower->links = (PatLink *) (lower + 1);
+ lower->items = (int *) (lower->links + n);
+ for (child = lower->children; child != NULL; child = child->sibling)
+	child->parent = lower;
+
+ for (i=0; i < n; i++) {
+	lower->items[i] = node->items[d + i];
+	lower->links[i] = node->links[d + i];
+	lower->links[i]->node = lower;
+	lower->links[i]->pos = i;
+ }
+
+ node->numItems = d;
+ node->children = lower;
+ return;
+}
+/******************************************************************************************
+ * Function: insertPatTree
+ *
+ * Description:
+ *	Insert the frequent items of a transaction (or a prefix path) into
+ *	a Patricia FP-tree.  The items are matched run by run; a run that
+ *	matches only in part is split first, and the unmatched rest of the
+ *	items becomes one new run.
+ *	If the tree exceeds the memory budget, treeOverflow is set and the
+ *	insertion stops.
+ *
+ * Invoked from:	
+ *	buildPatTree()
+ *	patGrowth()
+ *
+ * Functions to be invoked:
+ *	newPatNode(), splitPatNode()
+ *
+ * Input parameters:
+ *	root	-> Root of the tree
+ *	ranks	-> The items, ascending
+ *	n	-> Number of items
+ *	count	-> Count of the items
+ *	header	-> Header table of the tree
+ */
+void FPMiner::insertPatTree(PatTreeNode root, int *ranks, int n, int count, PatLink *header)
+{
+ PatTreeNode T = root;
+ PatTreeNode child;
+ int ptr = 0;
+ int d;
+
+ while (ptr < n) {
+	for (child = T->children; (child != NULL) && (child->items[0] != ranks[ptr]); child = child->sibling)
+		;
+	if (child == NULL) {
+		newPatNode(T, ranks + ptr, n - ptr, count, header);
+		return;
+	}
+
+	d = 1;
+	while ((d < child->numItems) && (ptr + d < n) && (child->items[d] == ranks[ptr + d]))
+		d++;
+	if (d < child->numItems) {
+		splitPatNode(child, d);
+		if (treeOverflow)
+			return;
+	}
+	child->count += count;
+	ptr += d;
+	T = child;
+ }
+ return;
+}
+/******************************************************************************************
+ * Function: buildPatTree
+ *
+ * Description:
+ *	Build the initial Patricia FP-tree, as buildTree() does for the FP-tree.
+ *	The building stops as soon as the tree exceeds the memory budget.
+ *
+ * Invoked from:	
+ *	build()
+ *
+ * Functions to be invoked:
+ *	openReader(), nextTrans(), closeReader()
+ *	insertPatTree()
+ *
+ * Member variables:
+ *	patRoot		-> Root of the initial Patricia FP-tree
+ *	patHeader	-> Its header table
+ *
+ * Return:
+ *	1 if the tree is built, 0 if it exceeds the memory budget.
+ */
+int FPMiner::buildPatTree()
+{
+ vector<int> ranks(numItem + 1);	/* Ranks of the frequent items of a transaction */
+ int count;
+ TransReader reader;
+ int transSize;
+ int i, j;
+
+ patHeader = (PatLink *) calloc (numLarge[0], sizeof(PatLink));
+ if (patHeader == NULL) {
+	throw FPError("out of memory");
+ }
+ patRoot = newPatRoot();
+ treeBytes = 0;
+ treeOverflow = 0;
+ numNodes = 1;
+ treeThreshold = threshold;
+
+ openReader(&reader, config.dataFile.c_str(), &dict, config.tokenizer, config.hugePages);
+ for (i=0; i < numTrans; i++) {
+	if ((transSize = nextTrans(&reader)) < 0)
+		break;
+	count = 0;
+	for (j=0; j < transSize; j++) {
+		if (itemRank[reader.items[j]] >= 0)
+			ranks[count++] = itemRank[reader.items[j]];
+	}
+	sort(ranks.begin(), ranks.begin() + count);
+	insertPatTree(patRoot, &ranks[0], count, 1, patHeader);
+	if (treeOverflow)
+		break;
+ }
+ closeReader(&reader);
+
+ return !treeOverflow;
+}
+/******************************************************************************************
+ * Function: patBase
+ *
+ * Description:
+ *	Build the conditional pattern base of an item of a Patricia FP-tree into
+ *	condBase, as loop_same_items() does for the FP-tree: the prefix path of
+ *	an entry is the part of its run before the item, then the runs of the
+ *	ancestors.
+ *
+ * Invoked from:	
+ *	patGrowth()
+ *
+ * Functions to be invoked:
+ *	growArray()
+ *
+ * Input parameters:
+ *	hlink	-> First entry of the item's chain
+ *	numRank	-> All the ranks on the prefix paths are below numRank
+ *
+ * Member variables:
+ *	condBase	-> The conditional pattern base
+ */
+void FPMiner::patBase(PatLink hlink, int numRank)
+{
+ CondBase *base = &condBase;
+ PatLink e;
+ PatTreeNode t;
+ int start, count, r, i;
+
+ base->numPaths = 0;
+ base->numRanks = 0;
+ memset(base->support, 0, sizeof(int) * numRank);
+
+ for (e = hlink; e != NULL; e = e->next) {
+	start = base->numRanks;
+	count = e->node->count;
+	i = e->pos;
+	for (t = e->node; t->parent != NULL; t = t->parent, i = t->numItems) {
+		while (--i >= 0) {
+			if (base->numRanks == base->sizeRanks)
+				base->ranks = (int *) growArray(base->ranks, &base->sizeRanks, sizeof(int));
+			r = t->items[i];
+			base->ranks[base->numRanks++] = r;
+			base->support[r] += count;
+		}
+	}
+	if (base->numRanks == start)
+		continue;
+
+	reverse(base->ranks + start, base->ranks + base->numRanks);
+	if (base->numPaths == base->sizePaths) {
+		r = base->sizePaths;
+		base->pathLen = (int *) growArray(base->pathLen, &r, sizeof(int));
+		base->pathCount = (int *) growArray(base->pathCount, &base->sizePaths, sizeof(int));
+	}
+	base->pathLen[base->numPaths] = base->numRanks - start;
+	base->pathCount[base->numPaths] = count;
+	base->numPaths++;
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: patGrowth
+ *
+ * Description:
+ *	FP-growth over a Patricia FP-tree, as fpGrowth() does over an FP-tree,
+ *	with the conditional trees built as Patricia FP-trees too.
+ *
+ * Invoked from:	
+ *	mine()
+ *	patGrowth()
+ *
+ * Functions to be invoked:
+ *	patBase()	-> Build the conditional pattern base
+ *	newPatRoot(), insertPatTree(), destroyPatTree()
+ *	addLargeItemset()
+ *	patGrowth()
+ *
+ * Input parameters:
+ *	header	-> Header table of the tree, by rank
+ *	numRank	-> All the ranks of the tree are below numRank
+ *	itemset	-> itemset[0..k-1] = Item IDs of the suffix
+ *	k	-> Size of the suffix
+ *
+ * Member variables:
+ *	condBase	-> Reused for every conditional pattern base
+ *	treeBytes, treeOverflow, numNodes	-> Accounting of the conditional tree being built
+ */
+void FPMiner::patGrowth(PatLink *header, int numRank, int *itemset, int k)
+{
+ CondBase *base = &condBase;
+ PatTreeOwner condRoot;
+ vector<PatLink> condHeader;
+ PatLink e;
+ vector<int> ranks(numRank + 1);	/* Large items of a path */
+ long saveBytes;
+ int saveNodes;
+ int support, count;
+ int r, rr, i, j, off;
+
+ if (base->support == NULL) {
+	base->support = (int *) malloc (sizeof(int) * numLarge[0]);
+	if (base->support == NULL) {
+		throw FPError("out of memory");
+	}
+ }
+
+ for (r=numRank-1; r >= 0; r--) {
+	if (header[r] == NULL)
+		continue;
+	support = 0;
+	for (e = header[r]; e != NULL; e = e->next)
+		support += e->node->count;
+	if (support < threshold)
+		continue;
+
+	itemset[k] = largeItem1[r];
+	if (k >= 1)
+		addLargeItemset(itemset, k+1, support);
+	if ((k+1 >= realK) || (r == 0))
+		continue;
+
+	/* Build the conditional Patricia FP-tree of the item */
+	patBase(header[r], r);
+	if (base->numPaths == 0)
+		continue;
+
+	condHeader.assign(r, (PatLink) NULL);
+	condRoot.reset(newPatRoot());
+	saveBytes = treeBytes;
+	saveNodes = numNodes;
+	treeBytes = 0;
+	treeOverflow = 0;
+	numNodes = 1;
+
+	for (i=0, off=0; i < base->numPaths; off += base->pathLen[i], i++) {
+		count = 0;
+		for (j=0; j < base->pathLen[i]; j++) {
+			rr = base->ranks[off + j];
+			if (base->support[rr] >= threshold)
+				ranks[count++] = rr;
+		}
+		if (count == 0)
+			continue;
+		insertPatTree(condRoot.get(), &ranks[0], count, base->pathCount[i], &condHeader[0]);
+		if (treeOverflow) {
+			throw FPError("a conditional FP-tree exceeds the memory budget");
+		}
+	}
+
+	patGrowth(&condHeader[0], r, itemset, k+1);
+
+	condRoot.reset();
+	treeBytes = saveBytes;
+	numNodes = saveNodes;
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: chooseEngine
+ *
+ * Description:
+ *	Choose the mining engine if it is not given in the config. file.
+ *	The bitset engine is chosen for dense DBs, i.e. few items compared
+ *	with the number of transactions, if the bitsets of the large 1-items
+ *	fit in BITSET_MAX_BYTES; otherwise the FP-tree is used, mined by FP-growth.
+ *
+ * Invoked from:	
+ *	build()
+ *
+ * Member variables:
+ *	engine	-> The mining engine
+ */
+void FPMiner::chooseEngine()
+{
+ if (engine == ENGINE_AUTO) {
+	if (((double) numItem * BITSET_RATIO <= numTrans) &&
+	    ((double) numLarge[0] * ((numTrans + 63) / 64) * sizeof(unsigned long long) <= BITSET_MAX_BYTES))
+		engine = ENGINE_BITSET;
+	else
+		engine = ENGINE_FPGROWTH;
+ }
+ report("\nengine = %s\n", engineName[engine]);
+
+ return;
+}
+/******************************************************************************************
+ * Function: build
+ *
+ * Description:
+ *	Find the frequent 1-itemsets and build the structure the chosen engine mines:
+ *	the initial FP-tree (or Patricia FP-tree), the bitsets or the tid-lists.
+ *	If the FP-tree exceeds the memory budget it is given up, and mine()
+ *	mines projected DBs spilled to disk instead.
+ *	With shards, the fpgrowth or fptree engine mines the DB in worker
+ *	processes, see mineShards().
+ *	With a checkpoint file, the FP-tree of the fpgrowth engine is saved to it;
+ *	if the file is there already, the job resumes from it instead.
+ *	A rule file is refused with an include list: the subsets of an itemset
+ *	without an item to include are not counted, and a rule needs their supports.
+ *	On a NUMA system the build is not bound: only the shard workers of
+ *	mineShards() are placed on the nodes.
+ *
+ * Functions to be invoked: 
+ *	loadCheckpoint()	-> Resume from the checkpoint
+ *	pass1()		-> Scan DB and find frquent 1-itemsets
+ *	chooseEngine()	-> Choose between the FP-tree and the bitsets
+ *	buildTree()	-> Build the initial FP-tree
+ *	buildPatTree()	-> Build the initial Patricia FP-tree
+ *	buildBitsets()	-> Build the bitsets of the bitset engine
+ *	buildTidLists()	-> Build the tid-lists of the tid-list/diffset engine
+ *	relayoutTree()	-> Lay the FP-tree out in depth-first order
+ *	saveTree()	-> Save the FP-tree to the checkpoint
+ *	numaNodes()	-> Report the NUMA nodes
+ *	With shards, nothing is built: each worker of mine() builds its own FP-tree.
+ *	In query mode, the FP-tree is built whatever the engine, for serve().
+ */
+void FPMiner::build()
+{
+#ifdef __linux__
+ vector<cpu_set_t> cpus;
+ int nodes;
+#endif
+
+ if ((!config.ruleFile.empty()) && (!config.include.empty())) {
+	throw FPError("association rules do not take an include list");
+ }
+
+ /* resume an interrupted job ------------------*/
+ if ((!config.checkpointFile.empty()) && (loadCheckpoint())) {
+	show_time(2);
+	return;
+ }
+
+ /* pass 1 : Mine the large 1-itemsets -------------*/
+ report("\npass1\n");
+ pass1();
+ if (numLarge[0] == 0) return;
+
+ chooseEngine();
+ if ((!config.checkpointFile.empty()) && (engine != ENGINE_FPGROWTH))
+	report("checkpoints are only saved by the fpgrowth engine\n");
+ show_time(1);
+ if ((!config.query.empty()) && (engine != ENGINE_FPTREE) && (engine != ENGINE_FPGROWTH)) {
+	/* queries are answered from the FP-tree ---*/
+	engine = ENGINE_FPGROWTH;
+	report("query mode: engine = %s\n", engineName[engine]);
+ }
+ if ((config.shards > 1) && (config.query.empty())) {
+	/* the shards build their own FP-trees -----*/
+	if (engine != ENGINE_FPTREE)
+		engine = ENGINE_FPGROWTH;
+	report("mining in %d shards with the %s engine\n", config.shards, engineName[engine]);
+	show_time(2);
+	return;
+ }
+#ifdef __linux__
+ if ((nodes = numaNodes(cpus)) > 1)
+	report("NUMA: %d nodes, the build is not bound; only shard workers are placed on nodes\n", nodes);
+#endif
+ if ((engine == ENGINE_ECLAT) || (engine == ENGINE_DECLAT)) {
+	/* create the tid-lists --------------------*/
+	report("\nbuildTidLists\n");
+	buildTidLists();
+ } else if (engine == ENGINE_BITSET) {
+	/* create the bitsets ----------------------*/
+	report("\nbuildBitsets\n");
+	buildBitsets();
+ } else if (engine == ENGINE_PATRICIA) {
+	/* create Patricia FP-tree -----------------*/
+	report("\nbuildPatTree\n");
+	if (!buildPatTree()) {
+		report("Patricia FP-tree exceeds the memory budget (%ld bytes), partitioning the DB\n", config.memBudget);
+		destroyPatTree(patRoot);
+		patRoot = NULL;
+	} else
+		report("%d nodes, %ld bytes\n", numNodes, treeBytes);
+ } else {
+	/* create FP-tree --------------------------*/
+ 	report("\nbuildTree\n");
+ 	if (!buildTree(root)) {
+		report("FP-tree exceeds the memory budget (%ld bytes), partitioning the DB\n", config.memBudget);
+		destroyTree(root);
+		root = NULL;
+	} else {
+		report("%d nodes, %ld bytes\n", numNodes, treeBytes);
+		if (config.relayout)
+			relayoutTree();
+		if ((!config.checkpointFile.empty()) && (engine == ENGINE_FPGROWTH))
+			saveTree();
+	}
+ }
+ show_time(2);
+
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: mine
+ *
+ * Description:
+ *	Mine the large k-itemsets (k = 2 to realK) with the chosen engine
+ *	and put them into their canonical order.  To be invoked after build(),
+ *	and again after setThreshold().
+ *	If the itemsets are to be written in the order of their items, with
+ *	no rules and no checkpoint, what the shards and the projected DBs
+ *	find is spilled to sorted runs as it comes (spillRuns).
+ *
+ * Functions to be invoked: 
+ *	traverse_list(), storeLargeItemsets()	-> Mine the initial FP-tree
+ *	fpGrowth()	-> Mine the initial FP-tree with conditional FP-trees
+ *	openCheckpointLog()	-> Save the progress of fpGrowth() while it mines
+ *	patGrowth()	-> Mine the initial Patricia FP-tree
+ *	partitionAndMine()	-> Mine projected DBs if the FP-tree exceeds the memory budget
+ *	mineShards()	-> Mine the DB in worker processes
+ *	mineBitsets()	-> Mine with the bitset engine
+ *	mineEclat()	-> Mine with the tid-list/diffset engine
+ *	sortLargeItemsets()
+ */
+void FPMiner::mine()
+{
+ vector<int> itemset(realK + 1);
+
+ spillRuns = (config.outOrder == OUT_ITEMS) && (config.ruleFile.empty()) && (ckptRank < 0);
+ /* Mine the large k-itemsets (k = 2 to realK) -----*/
+ if (numLarge[0] > 0) {
+	if ((config.counters) && (simTag == NULL)) {
+		simTag = (unsigned long long *) calloc (SIM_CACHE_LINES, sizeof(unsigned long long));
+		if (simTag == NULL) {
+			throw FPError("out of memory");
+		}
+	}
+	walkSteps = walkMisses = 0;
+	show_time(3);
+	if (config.shards > 1)
+		mineShards();
+	else if ((engine == ENGINE_ECLAT) || (engine == ENGINE_DECLAT))
+		mineEclat();
+	else if (engine == ENGINE_BITSET)
+		mineBitsets();
+	else if ((engine == ENGINE_PATRICIA) && (patRoot != NULL)) {
+		patGrowth(patHeader, numLarge[0], &itemset[0], 0);
+	} else if (root == NULL) {
+		/* mine projected DBs spilled to disk -----*/
+		partitionAndMine(NULL, numLarge[0], support1, NULL, 0);
+	} else if (engine == ENGINE_FPGROWTH) {
+		if (ckptRank >= 0)
+			openCheckpointLog();
+		report("conditional FP-tree nodes: %d-bit ranks, %d-bit counts at most\n",
+			(numLarge[0] <= 65536) ? 16 : 32, (numTrans <= 65535) ? 16 : 32);
+		fpGrowth(headerTableLink, numLarge[0], &itemset[0], 0);
+		if (ckptLog != NULL) {
+			/* Later mining (after setThreshold()) is not checkpointed */
+			fclose(ckptLog);
+			ckptLog = NULL;
+			ckptRank = -1;
+		}
+	} else {
+		mp.clear();
+		traverse_list(root, realK);
+		storeLargeItemsets(mp, NULL, 0);
+		mp.clear();
+	}
+	show_time(4);
+	if (simTag != NULL)
+		report("pattern bases: %ld node visits, %ld simulated cache misses\n", walkSteps, walkMisses);
+ }
+
+ sortLargeItemsets();
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: streamResults
+ *
+ * Description:
+ *	Hand every large itemset to the callback, smaller itemsets first and
+ *	each size in descending order of support, or, for a size spilled to
+ *	sorted runs while mining (OUT_ITEMS), in ascending order of the item
+ *	IDs.  To be invoked after mine().
+ *
+ * Functions to be invoked:
+ *	mergeItemsets()
+ *
+ * Input parameters:
+ *	callback	-> Receiver of the itemsets
+ *	user		-> Passed on to the callback
+ */
+void FPMiner::streamResults(ItemsetCallback callback, void *user)
+{
+ LargeItemPtr aLargeItemset;
+ vector<long long> keys(realK + 1);
+ int k;
+
+ for (k=1; k <= realK; k++) {
+	if ((itemRuns != NULL) && (itemRuns[k-1].fp != NULL)) {
+		mergeItemsets(k, callback, user);
+		continue;
+	}
+	for (aLargeItemset = largeItemset[k-1]; aLargeItemset != NULL; aLargeItemset = aLargeItemset->next) {
+		itemKeys(aLargeItemset->itemset, k, &keys[0]);
+		callback(&keys[0], k, aLargeItemset->support, user);
+	}
+ }
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: numLargeItemsets
+ *
+ * Description:
+ *	Number of large k-itemsets found.
+ */
+int FPMiner::numLargeItemsets(int k) const
+{
+ LargeItemPtr aLargeItemset;
+ int n;
+
+ if ((k < 1) || (k > realK)) return 0;
+ if (k > 1) return numLarge[k-1];
+
+ /* numLarge[0] counts the items of the FP-tree, which may be
+    below a threshold raised by setThreshold() */
+ n = 0;
+ for (aLargeItemset = largeItemset[0]; aLargeItemset != NULL; aLargeItemset = aLargeItemset->next)
+	n++;
+ return n;
+}
+
+
+/******************************************************************************************
+ * Function: clearLargeItemsets
+ *
+ * Description:
+ *	Drop the large k-itemsets (k >= 2) found so far, spilled ones included,
+ *	and the large 1-itemsets below the threshold, together with the hash
+ *	index over them.
+ *
+ * Invoked from:	
+ *	setThreshold()
+ *	emitWindow()
+ *
+ * Input parameters:
+ *	all	-> Drop all the large 1-itemsets too
+ *
+ * Member variables:
+ *	largeItemset[], numLarge[], itemsetIndex, itemRuns, numSpilled
+ */
+void FPMiner::clearLargeItemsets(int all)
+{
+ LargeItemPtr aLargeItemset;
+ LargeItemPtr *prev;
+ int i;
+
+ for (i=1; i < realK; i++) {
+	while ((aLargeItemset = largeItemset[i]) != NULL) {
+		largeItemset[i] = aLargeItemset->next;
+		free(aLargeItemset->itemset);
+		free(aLargeItemset);
+	}
+	numLarge[i] = 0;
+ }
+ delete[] itemRuns;
+ itemRuns = NULL;
+ numSpilled = 0;
+
+ prev = &largeItemset[0];
+ while ((aLargeItemset = *prev) != NULL) {
+	if ((all) || (aLargeItemset->support < threshold)) {
+		*prev = aLargeItemset->next;
+		free(aLargeItemset->itemset);
+		free(aLargeItemset);
+	} else
+		prev = &aLargeItemset->next;
+ }
+ if (all)
+	numLarge[0] = 0;
+
+ if (itemsetIndex != NULL) {
+	for (i=0; i < realK; i++)
+		free(itemsetIndex[i].slot);
+	free(itemsetIndex);
+	itemsetIndex = NULL;
+ }
+
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: setThreshold
+ *
+ * Description:
+ *	Raise the support threshold of a job whose FP-tree is in memory and
+ *	drop the results of the previous mining; mine() then mines the
+ *	same FP-tree again.  The threshold cannot go below the one the
+ *	FP-tree was built with, as the items below it are not in the tree.
+ *
+ * Functions to be invoked: 
+ *	clearLargeItemsets()
+ *
+ * Input parameters:
+ *	thresholdDecimal	-> Normalized support threshold, range: (0, 1]
+ */
+void FPMiner::setThreshold(double thresholdDecimal)
+{
+ int newThreshold;
+
+ if ((root == NULL) && (patRoot == NULL)) {
+	throw FPError("re-mining needs the FP-tree in memory");
+ }
+
+ newThreshold = thresholdDecimal * numTrans;
+ if (newThreshold == 0) newThreshold = 1;
+ if (newThreshold < treeThreshold) {
+	throw FPError("the threshold cannot go below the one the FP-tree was built with");
+ }
+
+ config.thresholdDecimal = thresholdDecimal;
+ threshold = newThreshold;
+ report("threshold = %d\n", threshold);
+ clearLargeItemsets(0);
+
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: writeResults
+ *
+ * Description:
+ *	Output the large itemsets to the result file and the association rules
+ *	to the rule file.  To be invoked after mine().
+ *	The job is then complete, and its checkpoint is removed.
+ *
+ * Functions to be invoked: 
+ *	writeLargeItemsets()	-> Write the large itemsets to the result file
+ *	genRules()	-> Generate the association rules
+ */
+void FPMiner::writeResults()
+{
+ writeLargeItemsets();
+ genRules();
+ if (!config.checkpointFile.empty()) {
+	remove(config.checkpointFile.c_str());
+	remove((config.checkpointFile + ".log").c_str());
+ }
+ show_time(5);
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: checkpointJob
+ *
+ * Description:
+ *	What a checkpoint must be resumed with, besides expectedK and
+ *	thresholdDecimal: the data file, by name, size and time of the last
+ *	change, and the item constraints, which drop transactions from the tree.
+ */
+static string checkpointJob(const FPConfig &config)
+{
+ const string *file[2] = {&config.dataFile, &config.priceFile};
+ struct stat st;
+ string job;
+ int i;
+
+ for (i=0; i < 2; i++) {
+	job += ((i == 0) ? "data " : "\nprices ") + *file[i];
+	if ((!file[i]->empty()) && (stat(file[i]->c_str(), &st) == 0))
+		job += " " + to_string((long long) st.st_size) + " " + to_string((long long) st.st_mtime);
+ }
+ job += "\ninclude " + config.include + "\nexclude " + config.exclude + "\nmaxPrice " + to_string(config.maxPrice);
+ return job;
+}
+/******************************************************************************************
+ * Function: readBlock
+ *
+ * Description:
+ *	Read n elements from a checkpoint file, which must hold them.
+ */
+static void readBlock(FILE *fp, void *p, size_t size, size_t n)
+{
+ if (fread(p, size, n, fp) != n) {
+	throw FPError("checkpoint file is truncated");
+ }
+ return;
+}
+/******************************************************************************************
+ * Function: writeTreeNode
+ *
+ * Description:
+ *	Write the subtree rooted at a node to a checkpoint file, in preorder:
+ *	for each node its item, count and number of children.
+ *
+ * Invoked from:	
+ *	saveTree()
+ *	writeTreeNode()
+ */
+static void writeTreeNode(FILE *fp, FPTreeNode node)
+{
+ childLink link;
+ int rec[3];
+
+ rec[0] = node->item;
+ rec[1] = node->count;
+ rec[2] = 0;
+ for (link = node->children; link != NULL; link = link->next)
+	rec[2]++;
+ fwrite(rec, sizeof(int), 3, fp);
+ for (link = node->children; link != NULL; link = link->next)
+	writeTreeNode(fp, link->node);
+
+ return;
+}
+/******************************************************************************************
+ * Function: readTreeNode
+ *
+ * Description:
+ *	Read a subtree written by writeTreeNode() and add it under a node,
+ *	linking its nodes into the header table.
+ *
+ * Invoked from:	
+ *	loadCheckpoint()
+ *	readTreeNode()
+ *
+ * Functions to be invoked:
+ *	newTreeNode()
+ *
+ * Input parameters:
+ *	fp	-> The checkpoint file
+ *	parent	-> Parent of the subtree
+ *	tail	-> tail[r] = last node of the header table chain of rank r
+ *
+ * Member variables:
+ *	headerTableLink	-> Header table of the initial FP-tree
+ *	itemRank[]	-> (read only)
+ */
+void FPMiner::readTreeNode(FILE *fp, FPTreeNode parent, FPTreeNode *tail)
+{
+ childLink newNode;
+ childLink *last;
+ FPTreeNode node;
+ int rec[3];
+ int i, r;
+
+ readBlock(fp, rec, sizeof(int), 3);
+ if ((rec[0] < 0) || (rec[0] >= numItem) || ((r = itemRank[rec[0]]) < 0)) {
+	throw FPError("checkpoint file is corrupt");
+ }
+ if ((newNode = newTreeNode()) == NULL) {
+	throw FPError("out of memory");
+ }
+
+ node = newNode->node;
+ node->item = rec[0];
+ node->count = rec[1];
+ node->numPath = 0;
+ node->numChildren = rec[2];
+ node->parent = parent;
+ node->children = NULL;
+ node->hlink = NULL;
+
+ /* Append to the children of the parent, keeping their order */
+ for (last = &parent->children; *last != NULL; last = &(*last)->next)
+	;
+ newNode->next = NULL;
+ *last = newNode;
+
+ if (tail[r] == NULL)
+	headerTableLink[r] = node;
+ else
+	tail[r]->hlink = node;
+ tail[r] = node;
+
+ for (i=0; i < rec[2]; i++)
+	readTreeNode(fp, node, tail);
+ if (rec[2] == 0)
+	node->numPath = 1;
+ parent->numPath += node->numPath;
+
+ return;
+}
+/******************************************************************************************
+ * Function: saveTree
+ *
+ * Description:
+ *	Save the job after build() to the checkpoint file: the parameters it was
+ *	built with, the job it belongs to (see checkpointJob()), the item IDs,
+ *	the supports of the 1-items and the FP-tree.
+ *	The file is written under a temporary name and renamed, so a checkpoint
+ *	file is always complete.
+ *
+ * Invoked from:	
+ *	build()
+ *
+ * Functions to be invoked:
+ *	checkpointJob(), writeTreeNode()
+ *
+ * Member variables:
+ *	ckptRank	-> All the items are still to be mined
+ */
+void FPMiner::saveTree()
+{
+ string tmpName = config.checkpointFile + ".tmp";
+ string job = checkpointJob(config);
+ childLink link;
+ FILE *fp;
+ int head[8];
+ int n;
+
+ if ((fp = fopen(tmpName.c_str(), "wb")) == NULL) {
+        throw FPError(string("Can't open checkpoint file, ") + tmpName + ".");
+ }
+
+ fwrite("FPTCKPT2", 1, 8, fp);
+ head[0] = expectedK;
+ head[1] = realK;
+ head[2] = numItem;
+ head[3] = numTrans;
+ head[4] = threshold;
+ head[5] = numLarge[0];
+ head[6] = 0;
+ head[7] = 0;
+ for (link = root->children; link != NULL; link = link->next)
+	head[6]++;
+ fwrite(head, sizeof(int), 8, fp);
+ fwrite(&config.thresholdDecimal, sizeof(float), 1, fp);
+ n = job.size();
+ fwrite(&n, sizeof(int), 1, fp);
+ fwrite(job.data(), 1, n, fp);
+ fwrite(dict.key, sizeof(long long), numItem, fp);
+ fwrite(largeItem1, sizeof(int), numItem, fp);
+ fwrite(support1, sizeof(int), numItem, fp);
+ for (link = root->children; link != NULL; link = link->next)
+	writeTreeNode(fp, link->node);
+
+ if ((ferror(fp)) | (fclose(fp) != 0)) {
+        throw FPError(string("Can't write checkpoint file, ") + tmpName + ".");
+ }
+ if (rename(tmpName.c_str(), config.checkpointFile.c_str()) != 0) {
+        throw FPError(string("Can't write checkpoint file, ") + config.checkpointFile + ".");
+ }
+
+ ckptRank = numLarge[0];
+ report("checkpoint: FP-tree saved to %s\n", config.checkpointFile.c_str());
+ return;
+}
+/******************************************************************************************
+ * Function: loadCheckpoint
+ *
+ * Description:
+ *	Resume a job from its checkpoint instead of pass1() and buildTree():
+ *	restore the large 1-items and the FP-tree saved by saveTree(), then
+ *	the itemsets of the log up to its last complete checkpoint, which
+ *	tells from which item of the header table fpGrowth() goes on.
+ *
+ * Invoked from:	
+ *	build()
+ *
+ * Functions to be invoked:
+ *	checkpointJob(), readBlock(), lookupDict()
+ *	newRoot(), readTreeNode(), relayoutTree()
+ *	addLargeItemset()
+ *
+ * Member variables:
+ *	everything pass1() and buildTree() set
+ *	ckptRank	-> The items of rank >= ckptRank are mined
+ *
+ * Return:
+ *	1 if the job is resumed, 0 if there is no checkpoint file.
+ */
+int FPMiner::loadCheckpoint()
+{
+ vector<int> pending;	/* Itemsets of the log after its last complete checkpoint */
+ vector<FPTreeNode> tail;
+ char magic[8];
+ FileOwner fp;
+ string job;
+ float thresholdDecimal;
+ int head[8];
+ int rec[2];
+ int *itemset;
+ int i, k, pos, size;
+
+ fp.reset(fopen(config.checkpointFile.c_str(), "rb"));
+ if (fp == NULL)
+	return 0;
+
+ readBlock(fp.get(), magic, 1, 8);
+ readBlock(fp.get(), head, sizeof(int), 8);
+ readBlock(fp.get(), &thresholdDecimal, sizeof(float), 1);
+ readBlock(fp.get(), &size, sizeof(int), 1);
+ if ((memcmp(magic, "FPTCKPT2", 8) != 0) || (size < 0) || (size > 65536)) {
+        throw FPError(string("Not a checkpoint file, ") + config.checkpointFile + ".");
+ }
+ job.resize(size);
+ readBlock(fp.get(), &job[0], 1, size);
+ if ((head[0] != expectedK) || (thresholdDecimal != config.thresholdDecimal) || (job != checkpointJob(config))) {
+        throw FPError(string("Checkpoint file of another job, ") + config.checkpointFile + ".");
+ }
+ report("\nresuming from %s\n", config.checkpointFile.c_str());
+
+ realK = head[1];
+ numItem = head[2];
+ numTrans = head[3];
+ threshold = head[4];
+ treeThreshold = threshold;
+ engine = ENGINE_FPGROWTH;
+
+ /* The large 1-items, as left by pass1() */
+ largeItemset = (LargeItemPtr *) calloc (realK, sizeof(LargeItemPtr));
+ numLarge = (int *) calloc (realK, sizeof(int));
+ largeItem1 = (int *) malloc (sizeof(int) * numItem);
+ support1 = (int *) malloc (sizeof(int) * numItem);
+ itemRank = (int *) malloc (sizeof(int) * numItem);
+ dict.sizeKeys = numItem + 1;
+ dict.key = (long long *) realloc (dict.key, sizeof(long long) * dict.sizeKeys);
+ if ((largeItemset == NULL) || (numLarge == NULL) || (largeItem1 == NULL) ||
+     (support1 == NULL) || (itemRank == NULL) || (dict.key == NULL)) {
+	throw FPError("out of memory");
+ }
+ readBlock(fp.get(), dict.key, sizeof(long long), numItem);
+ dict.numKeys = numItem;
+ for (size = dict.size; size < 2 * numItem + 2; size *= 2)
+	;
+ rehashDict(&dict, size);
+ readBlock(fp.get(), largeItem1, sizeof(int), numItem);
+ readBlock(fp.get(), support1, sizeof(int), numItem);
+ loadConstraints();
+ for (i=0; i < numItem; i++)
+	itemRank[i] = -1;
+ for (i=0; i < head[5]; i++)
+	itemRank[largeItem1[i]] = i;
+ for (i=head[5]-1; i >= 0; i--)
+	addLargeItemset(&largeItem1[i], 1, support1[i]);
+ numLarge[0] = head[5];
+ report("threshold = %d\n", threshold);
+ report("No. of large 1-itemsets (numLarge[0]) = %d\n", numLarge[0]);
+
+ /* The FP-tree */
+ headerTableLink = (FPTreeNode *) calloc (numLarge[0], sizeof(FPTreeNode));
+ if (headerTableLink == NULL) {
+	throw FPError("out of memory");
+ }
+ tail.assign(numLarge[0], NULL);
+ root = newRoot();
+ root->numPath = 0;
+ root->numChildren = head[6];
+ treeBytes = 0;
+ treeOverflow = 0;
+ numNodes = 1;
+ for (i=0; i < head[6]; i++)
+	readTreeNode(fp.get(), root, &tail[0]);
+ fp.reset();
+ report("%d nodes, %ld bytes\n", numNodes, treeBytes);
+ if (config.relayout)
+	relayoutTree();
+
+ /* The itemsets flushed by the completed checkpoints */
+ ckptRank = numLarge[0];
+ fp.reset(fopen((config.checkpointFile + ".log").c_str(), "rb"));
+ if (fp != NULL) {
+	while (fread(rec, sizeof(int), 2, fp.get()) == 2) {
+		if (rec[0] == 0) {
+			/* A complete checkpoint: rec[1] = first rank not mined */
+			for (pos=0; pos < (int) pending.size(); pos += pending[pos] + 2)
+				addLargeItemset(&pending[pos+2], pending[pos], pending[pos+1]);
+			pending.clear();
+			ckptRank = rec[1];
+			continue;
+		}
+		if ((rec[0] < 2) || (rec[0] > realK))
+			break;
+		k = rec[0];
+		pending.push_back(k);
+		pending.push_back(rec[1]);
+		pending.resize(pending.size() + k);
+		itemset = &pending[pending.size() - k];
+		if (fread(itemset, sizeof(int), k, fp.get()) != (size_t) k)
+			break;
+	}
+	fp.reset();
+ }
+ report("%d of %d items left to mine\n", ckptRank, numLarge[0]);
+
+ return 1;
+}
+/******************************************************************************************
+ * Function: openCheckpointLog
+ *
+ * Description:
+ *	Start the log of the itemsets found by fpGrowth().  The log is
+ *	rewritten with the itemsets found before the job was resumed, if any,
+ *	which drops what the log held after its last complete checkpoint.
+ *
+ * Invoked from:	
+ *	mine()
+ *
+ * Functions to be invoked:
+ *	saveProgress()
+ *
+ * Member variables:
+ *	ckptLog, ckptMark, ckptTime
+ */
+void FPMiner::openCheckpointLog()
+{
+ string logName = config.checkpointFile + ".log";
+ string tmpName = logName + ".tmp";
+
+ ckptMark = (LargeItemPtr *) calloc (realK, sizeof(LargeItemPtr));
+ if (ckptMark == NULL) {
+	throw FPError("out of memory");
+ }
+
+ if ((ckptLog = fopen(tmpName.c_str(), "wb")) == NULL) {
+        throw FPError(string("Can't open checkpoint file, ") + tmpName + ".");
+ }
+ saveProgress(ckptRank);
+ fclose(ckptLog);
+ if (rename(tmpName.c_str(), logName.c_str()) != 0) {
+	ckptLog = NULL;
+        throw FPError(string("Can't write checkpoint file, ") + logName + ".");
+ }
+ if ((ckptLog = fopen(logName.c_str(), "ab")) == NULL) {
+        throw FPError(string("Can't open checkpoint file, ") + logName + ".");
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: saveProgress
+ *
+ * Description:
+ *	Make a checkpoint: append the large itemsets found since the last one
+ *	to the log, each as <k> <support> <k items>, followed by the mark
+ *	0 <doneRank> that completes the checkpoint.
+ *
+ * Invoked from:	
+ *	fpGrowth()
+ *	openCheckpointLog()
+ *
+ * Input parameters:
+ *	doneRank	-> The items of rank >= doneRank are mined
+ *
+ * Member variables:
+ *	ckptLog		-> The log
+ *	ckptMark[]	-> Updated to the heads of the resulting lists
+ *	ckptRank, ckptTime
+ */
+void FPMiner::saveProgress(int doneRank)
+{
+ LargeItemPtr aLargeItemset;
+ int rec[2];
+ int k;
+
+ for (k=2; k <= realK; k++) {
+	for (aLargeItemset = largeItemset[k-1]; aLargeItemset != ckptMark[k-1]; aLargeItemset = aLargeItemset->next) {
+		rec[0] = k;
+		rec[1] = aLargeItemset->support;
+		fwrite(rec, sizeof(int), 2, ckptLog);
+		fwrite(aLargeItemset->itemset, sizeof(int), k, ckptLog);
+	}
+	ckptMark[k-1] = largeItemset[k-1];
+ }
+ rec[0] = 0;
+ rec[1] = doneRank;
+ fwrite(rec, sizeof(int), 2, ckptLog);
+ if ((fflush(ckptLog) != 0) || (ferror(ckptLog))) {
+        throw FPError(string("Can't write checkpoint file, ") + config.checkpointFile + ".log.");
+ }
+
+ ckptRank = doneRank;
+ ckptTime = time(NULL);
+ report("checkpoint: %d items left to mine\n", doneRank);
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: expireTrans
+ *
+ * Description:
+ *	Take a transaction that leaves the sliding window out of the FP-tree:
+ *	decrement the counts along its path.  Nodes whose count drops to zero
+ *	are left in the tree and counted in zeroNodes; pruneTree() removes them.
+ *
+ * Invoked from:	
+ *	stream()
+ *
+ * Input parameters:
+ *	items	-> The items of the transaction, ascending, as inserted
+ *	n	-> Number of items
+ *
+ * Member variables:
+ *	root, support1[], zeroNodes
+ */
+void FPMiner::expireTrans(int *items, int n)
+{
+ FPTreeNode T = root;
+ childLink link;
+ int j;
+
+ for (j=0; j < n; j++) {
+	for (link = T->children; (link != NULL) && (link->node->item != items[j]); link = link->next)
+		;
+	if (link == NULL) {
+		throw FPError("expired transaction not found in the window FP-tree");
+	}
+	T = link->node;
+	if (--(T->count) == 0)
+		zeroNodes++;
+	support1[items[j]]--;
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: pruneTree
+ *
+ * Description:
+ *	Remove the nodes of zero count from the window FP-tree.  The count of a
+ *	node is not smaller than the counts of its children, so such a node
+ *	heads a subtree of zero counts: the nodes are first unlinked from the
+ *	header table chains, then each such subtree is cut from its parent.
+ *
+ * Invoked from:	
+ *	emitWindow()
+ *
+ * Functions to be invoked:
+ *	destroyTree()
+ *
+ * Member variables:
+ *	root, headerTableLink[], zeroNodes
+ */
+void FPMiner::pruneTree()
+{
+ vector<FPTreeNode> stack;
+ FPTreeNode *prev;
+ FPTreeNode p;
+ childLink *link;
+ childLink dead;
+ int i;
+
+ for (i=0; i < numItem; i++) {
+	prev = &headerTableLink[i];
+	while ((p = *prev) != NULL) {
+		if (p->count == 0)
+			*prev = p->hlink;
+		else
+			prev = &p->hlink;
+	}
+ }
+
+ stack.push_back(root);
+ while (!stack.empty()) {
+	p = stack.back();
+	stack.pop_back();
+	link = &p->children;
+	while ((dead = *link) != NULL) {
+		if (dead->node->count == 0) {
+			*link = dead->next;
+			destroyTree(dead->node);
+			free(dead);
+			p->numChildren--;
+		} else {
+			stack.push_back(dead->node);
+			link = &dead->next;
+		}
+	}
+ }
+
+ zeroNodes = 0;
+ return;
+}
+/******************************************************************************************
+ * Function: emitWindow
+ *
+ * Description:
+ *	Mine the window FP-tree by FP-growth and append the large itemsets
+ *	of the window to the result file, after a line
+ *		# window <first>-<last>, threshold <threshold>
+ *	The threshold is thresholdDecimal times the number of transactions in the window.
+ *
+ * Invoked from:	
+ *	stream()
+ *
+ * Functions to be invoked:
+ *	pruneTree(), clearLargeItemsets(), addLargeItemset()
+ *	fpGrowth(), sortLargeItemsets()
+ *	writeItemsets()
+ *
+ * Input parameters:
+ *	fp	-> The result file
+ *	first	-> Number of transactions before the window
+ *	last	-> Number of transactions up to the end of the window
+ */
+void FPMiner::emitWindow(FILE *fp, long first, long last)
+{
+ vector<int> itemset(realK + 1);
+ int i;
+
+ threshold = config.thresholdDecimal * (last - first);
+ if (threshold == 0) threshold = 1;
+
+ if (zeroNodes > 0)
+	pruneTree();
+ clearLargeItemsets(1);
+
+ for (i=0; i < numItem; i++) {
+	if (support1[i] >= threshold) {
+		itemset[0] = i;
+		addLargeItemset(&itemset[0], 1, support1[i]);
+	}
+ }
+ fpGrowth(headerTableLink, numItem, &itemset[0], 0);
+ sortLargeItemsets();
+
+ fprintf(fp, "# window %ld-%ld, threshold %d\n", first + 1, last, threshold);
+ writeItemsets(fp);
+ fflush(fp);
+
+ return;
+}
+/******************************************************************************************
+ * Function: stream
+ *
+ * Description:
+ *	Mine a sliding window of the last config.window transactions of a
+ *	stream, read from the data file or from stdin ("-") until its end.
+ *	numTrans and numItem are not needed, the item IDs are numbered
+ *	as dense items as they are found.  The FP-tree of the window is kept up to date
+ *	rather than rebuilt: every config.batch transactions, the transactions
+ *	read are inserted and those that left the window are expired, and every
+ *	config.emitEvery transactions the large itemsets of the window are
+ *	appended to the result file (or stdout, "-").
+ *	The items of the tree are ordered by dense item, as the supports are not
+ *	known in advance; the transactions of the window are kept in a ring
+ *	to be expired.
+ *
+ * Invoked from:	
+ *	main()
+ *
+ * Functions to be invoked:
+ *	openReader(), nextTrans(), closeReader()
+ *	newRoot(), insert_tree()
+ *	expireTrans()
+ *	emitWindow()
+ */
+void FPMiner::stream()
+{
+ TransReader reader;
+ FileOwner out;		/* The result file, unless stdout */
+ FILE *fp;
+ vector<vector<int> > ring;	/* ring[t % numSlots] = items of transaction t of the window */
+ vector<int> ringSize;		/* Number of items of each ring slot */
+ int numSlots;
+ int window = config.window;
+ int batch = (config.batch > 0) ? config.batch : 1;
+ int emitEvery = (config.emitEvery > 0) ? config.emitEvery : window;
+ long seen = 0;		/* Transactions read */
+ long expired = 0;	/* Transactions expired */
+ long emitted = 0;	/* Transactions read at the last output */
+ int *items;
+ int itemCap = 0;	/* Capacity of the arrays indexed by dense item */
+ int transSize, n, slot, path;
+ int i, j;
+
+ realK = (expectedK > 0) ? expectedK : 1;	/* Grown with the transactions otherwise */
+ largeItemset = (LargeItemPtr *) calloc (realK, sizeof(LargeItemPtr));
+ numLarge = (int *) calloc (realK, sizeof(int));
+ numItem = 0;
+ numSlots = window + batch;
+ ring.resize(numSlots);
+ ringSize.resize(numSlots, 0);
+ if ((largeItemset == NULL) || (numLarge == NULL)) {
+	throw FPError("out of memory");
+ }
+
+ root = newRoot();
+ treeBytes = 0;
+ treeOverflow = 0;
+ numNodes = 1;
+ zeroNodes = 0;
+
+ if (config.outFile == "-")
+	fp = stdout;
+ else {
+	out.reset(fopen(config.outFile.c_str(), "w"));
+	if ((fp = out.get()) == NULL) {
+	        throw FPError(string("Can't open result file, ") + config.outFile + ".");
+	}
+ }
+ report("\nstream: window = %d, batch = %d, emitEvery = %d\n", window, batch, emitEvery);
+
+ openReader(&reader, config.dataFile.c_str(), &dict, config.tokenizer, config.hugePages);
+ reader.grow = 1;
+ do {
+	/* Insert a batch of transactions */
+	for (n=0; n < batch; n++) {
+		if ((transSize = nextTrans(&reader)) < 0)
+			break;
+
+		/* Grow the arrays indexed by dense item with the dictionary;
+		 * the ranks of the tree are the dense items, in the order found */
+		if (dict.sizeKeys > itemCap) {
+			support1 = (int *) realloc (support1, sizeof(int) * dict.sizeKeys);
+			largeItem1 = (int *) realloc (largeItem1, sizeof(int) * dict.sizeKeys);
+			itemRank = (int *) realloc (itemRank, sizeof(int) * dict.sizeKeys);
+			headerTableLink = (FPTreeNode *) realloc (headerTableLink, sizeof(FPTreeNode) * dict.sizeKeys);
+			condBase.support = (int *) realloc (condBase.support, sizeof(int) * dict.sizeKeys);
+			if ((support1 == NULL) || (largeItem1 == NULL) || (itemRank == NULL) ||
+			    (headerTableLink == NULL) || (condBase.support == NULL)) {
+				throw FPError("out of memory");
+			}
+			for (i=itemCap; i < dict.sizeKeys; i++) {
+				support1[i] = 0;
+				largeItem1[i] = itemRank[i] = i;
+				headerTableLink[i] = NULL;
+			}
+			itemCap = dict.sizeKeys;
+		}
+		numItem = dict.numKeys;
+
+		/* Grow the resulting lists with the transactions, if not limited */
+		if ((expectedK <= 0) && (transSize > realK)) {
+			largeItemset = (LargeItemPtr *) realloc (largeItemset, sizeof(LargeItemPtr) * transSize);
+			numLarge = (int *) realloc (numLarge, sizeof(int) * transSize);
+			if ((largeItemset == NULL) || (numLarge == NULL)) {
+				throw FPError("out of memory");
+			}
+			for (i=realK; i < transSize; i++) {
+				largeItemset[i] = NULL;
+				numLarge[i] = 0;
+			}
+			realK = transSize;
+		}
+
+		slot = seen % numSlots;
+		if ((int) ring[slot].size() < transSize)
+			ring[slot].resize(transSize);
+		items = ring[slot].data();
+		for (j=0; j < transSize; j++)
+			items[j] = reader.items[j];
+		sort(items, items + transSize);
+		ringSize[slot] = unique(items, items + transSize) - items;
+
+		for (j=0; j < ringSize[slot]; j++)
+			support1[items[j]]++;
+		path = 0;
+		insert_tree(items, items, 1, 0, ringSize[slot], root, headerTableLink, &path);
+		if (treeOverflow) {
+			throw FPError("the window FP-tree exceeds the memory budget");
+		}
+		seen++;
+	}
+
+	/* Expire the transactions that left the window */
+	for (; seen - expired > window; expired++) {
+		slot = expired % numSlots;
+		expireTrans(ring[slot].data(), ringSize[slot]);
+	}
+
+	if ((seen - emitted >= emitEvery) || ((n < batch) && (seen > emitted))) {
+		emitWindow(fp, expired, seen);
+		emitted = seen;
+	}
+ } while (n == batch);
+ closeReader(&reader);
+
+ report("%ld transactions\n", seen);
+ out.reset();
+ show_time(5);
+
+ return;
+}
+
+
+/******************************************************************************************
+ * Function: verifyCandidates
+ *
+ * Description:
+ *	Count the supports of the candidate itemsets in the full DB.
+ *	A candidate is only checked in the transactions containing its first item.
+ *
+ * Invoked from:	
+ *	preflight()
+ *
+ * Functions to be invoked:
+ *	openReader(), nextTrans(), closeReader()
+ *
+ * Input parameters:
+ *	cand		-> The items of the candidates, one after another, ascending
+ *	candK		-> candK[c] = size of candidate c
+ *
+ * Output parameter:
+ *	candSupport	-> candSupport[c] = support of candidate c in the DB
+ */
+void FPMiner::verifyCandidates(vector<int> &cand, vector<int> &candK, vector<int> &candSupport)
+{
+ vector<int> start(candK.size());	/* start[c] = position of candidate c in cand */
+ vector<int> first(numItem, -1);	/* first[item] = first candidate starting with the item */
+ vector<int> next(candK.size());	/* next[c] = next candidate with the same first item */
+ vector<int> mark(numItem, -1);		/* mark[item] = last transaction containing the item */
+ TransReader reader;
+ int transSize;
+ int c, i, j, pos;
+
+ for (c=0, pos=0; c < (int) candK.size(); pos += candK[c], c++) {
+	start[c] = pos;
+	next[c] = first[cand[pos]];
+	first[cand[pos]] = c;
+ }
+ candSupport.assign(candK.size(), 0);
+
+ openReader(&reader, config.dataFile.c_str(), &dict, config.tokenizer, config.hugePages);
+ for (i=0; i < numTrans; i++) {
+	if ((transSize = nextTrans(&reader)) < 0)
+		break;
+	for (j=0; j < transSize; j++)
+		mark[reader.items[j]] = i;
+	for (j=0; j < transSize; j++) {
+		for (c = first[reader.items[j]]; c >= 0; c = next[c]) {
+			for (pos=1; (pos < candK[c]) && (mark[cand[start[c] + pos]] == i); pos++)
+				;
+			if (pos == candK[c])
+				candSupport[c]++;
+		}
+		first[reader.items[j]] = -2 - first[reader.items[j]];	/* Count a repeated item once */
+	}
+	for (j=0; j < transSize; j++) {
+		if (first[reader.items[j]] < -1)
+			first[reader.items[j]] = -2 - first[reader.items[j]];
+	}
+ }
+ closeReader(&reader);
+
+ return;
+}
+/******************************************************************************************
+ * Function: preflight
+ *
+ * Description:
+ *	Estimate what mining the DB would produce, before committing to a full run.
+ *	pass1() keeps a random sample of config.sample transactions (reservoir
+ *	sampling); for each threshold of config.sampleThresholds, an FP-tree of
+ *	the sample is built and mined by FP-growth at the threshold scaled to the
+ *	sample.  The result file gets, for each threshold, the number of large
+ *	1-itemsets (exact, from pass1()), the estimated number of large k-itemsets,
+ *	and the mining time and FP-tree size of the sample scaled to the DB.
+ *	If config.verifySample is set, the itemsets found in the sample at the
+ *	lowest threshold are counted in the full DB, and the number of them that
+ *	are large at each threshold is given too.
+ *
+ * Invoked from:	
+ *	main()
+ *
+ * Functions to be invoked:
+ *	pass1()
+ *	newRoot(), insert_tree(), destroyTree(), q_sortA()
+ *	fpGrowth(), clearLargeItemsets()
+ *	verifyCandidates()
+ */
+void FPMiner::preflight()
+{
+ vector<double> thresholds;
+ vector<int> sampleSupport;		/* sampleSupport[item] = support of the item in the sample */
+ vector<vector<int> > estimate;		/* estimate[t][k-1] = large k-itemsets of the sample at threshold t */
+ vector<int> cand, candK, candSupport;	/* Candidates to be verified */
+ vector<int> verified;
+ LargeItemPtr aLargeItemset;
+ TreeOwner sampleRoot;
+ vector<FPTreeNode> header;
+ vector<int> freqItemP, indexList, itemset;
+ string list;
+ char *tok, *save;
+ FileOwner out;
+ FILE *fp;
+ double scale, secs;
+ clock_t start;
+ int fullThreshold;
+ int count, path;
+ int t, k, i, j;
+
+ report("\npass1\n");
+ pass1();
+ if ((numSample == 0) || (realK == 0))
+	return;
+
+ list = config.sampleThresholds;
+ for (tok = strtok_r(&list[0], ",", &save); tok != NULL; tok = strtok_r(NULL, ",", &save))
+	thresholds.push_back(atof(tok));
+ if (thresholds.empty())
+	thresholds.push_back(config.thresholdDecimal);
+ sort(thresholds.begin(), thresholds.end(), greater<double>());
+
+ /* Rank all the items, not only those large at the threshold of the config. file */
+ clearLargeItemsets(1);
+ for (i=0; i < numItem; i++)
+	itemRank[largeItem1[i]] = i;
+ sampleSupport.assign(numItem, 0);
+ for (i=0; i < numSample; i++) {
+	for (j=0; j < sampleLen[i]; j++)
+		sampleSupport[sampleTrans[i][j]]++;
+ }
+
+ freqItemP.resize(numItem + 1);
+ indexList.resize(numItem + 1);
+ itemset.resize(realK + 1);
+ out.reset(fopen(config.outFile.c_str(), "w"));
+ if ((fp = out.get()) == NULL) {
+        throw FPError(string("Can't open result file, ") + config.outFile + ".");
+ }
+ scale = (double) numTrans / numSample;
+ fprintf(fp, "# preflight: %d of %d transactions sampled\n", numSample, numTrans);
+
+ estimate.resize(thresholds.size());
+ for (t=0; t < (int) thresholds.size(); t++) {
+	numLarge[0] = numItem;
+	threshold = thresholds[t] * numSample;
+	if (threshold == 0) threshold = 1;
+
+	/* Build the FP-tree of the sample and mine it */
+	start = clock();
+	header.assign(numItem + 1, (FPTreeNode) NULL);
+	sampleRoot.reset(newRoot());
+	treeBytes = 0;
+	treeOverflow = 0;
+	numNodes = 1;
+	for (i=0; i < numSample; i++) {
+		count = 0;
+		for (j=0; j < sampleLen[i]; j++) {
+			if (sampleSupport[sampleTrans[i][j]] >= threshold) {
+				freqItemP[count] = sampleTrans[i][j];
+				indexList[count] = itemRank[sampleTrans[i][j]];
+				count++;
+			}
+		}
+		q_sortA(&indexList[0], &freqItemP[0], 0, count-1, count);
+		path = 0;
+		insert_tree(&freqItemP[0], &indexList[0], 1, 0, count, sampleRoot.get(), &header[0], &path);
+		if (treeOverflow) {
+			throw FPError("the FP-tree of the sample exceeds the memory budget");
+		}
+	}
+	fpGrowth(&header[0], numItem, &itemset[0], 0);
+	secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+	fullThreshold = thresholds[t] * numTrans;
+	if (fullThreshold == 0) fullThreshold = 1;
+	estimate[t].assign(realK, 0);
+	for (i=0; (i < numItem) && (support1[i] >= fullThreshold); i++)
+		estimate[t][0]++;
+	for (k=2; k <= realK; k++)
+		estimate[t][k-1] = numLarge[k-1];
+	fprintf(fp, "threshold %g (support %d): est. time %.3f secs, est. FP-tree %.1f MB\n",
+		thresholds[t], fullThreshold, secs * scale, treeBytes * scale / 1048576);
+	report("threshold %g: sample mined in %.3f secs\n", thresholds[t], secs);
+
+	/* The itemsets of the lowest threshold are the candidates to be verified */
+	if ((config.verifySample) && (t == (int) thresholds.size() - 1)) {
+		for (k=2; k <= realK; k++) {
+			for (aLargeItemset = largeItemset[k-1]; aLargeItemset != NULL; aLargeItemset = aLargeItemset->next) {
+				cand.insert(cand.end(), aLargeItemset->itemset, aLargeItemset->itemset + k);
+				candK.push_back(k);
+			}
+		}
+	}
+
+	clearLargeItemsets(0);
+	sampleRoot.reset();
+ }
+
+ if (config.verifySample) {
+	report("verifying %d candidates\n", (int) candK.size());
+	verifyCandidates(cand, candK, candSupport);
+ }
+
+ for (t=0; t < (int) thresholds.size(); t++) {
+	fullThreshold = thresholds[t] * numTrans;
+	if (fullThreshold == 0) fullThreshold = 1;
+	verified.assign(realK, 0);
+	for (i=0; i < (int) candK.size(); i++) {
+		if (candSupport[i] >= fullThreshold)
+			verified[candK[i]-1]++;
+	}
+
+	fprintf(fp, "\nthreshold %g\n", thresholds[t]);
+	fprintf(fp, "  k=1: %d (exact)\n", estimate[t][0]);
+	for (k=2; k <= realK; k++) {
+		if ((estimate[t][k-1] == 0) && (verified[k-1] == 0))
+			break;
+		fprintf(fp, "  k=%d: ~%d", k, estimate[t][k-1]);
+		if (config.verifySample)
+			fprintf(fp, ", %d of the candidates verified large", verified[k-1]);
+		fprintf(fp, "\n");
+	}
+ }
+ out.reset();
+ show_time(5);
+ return;
+}
+/******************************************************************************************
+ * Function: queryRanks
+ *
+ * Description:
+ *	Read the item IDs of the itemset of a query, the rest of the query
+ *	line being cut by strtok_r(), and turn them into ranks.
+ *
+ * Invoked from:	
+ *	answerQuery()
+ *
+ * Functions to be invoked:
+ *	lookupDict()
+ *
+ * Input parameters:
+ *	save	-> Position of strtok_r() in the query line
+ *
+ * Output parameter:
+ *	ranks	-> The ranks of the items, ascending and without duplicates
+ *
+ * Return:
+ *	1, or 0 if an item is not a large 1-item (or not in the DB at all).
+ */
+int FPMiner::queryRanks(char **save, vector<int> &ranks)
+{
+ char *tok;
+ int d, r;
+
+ ranks.clear();
+ while ((tok = strtok_r(NULL, " \t\r\n", save)) != NULL) {
+	d = lookupDict(&dict, atoll(tok), 0);
+	r = (d >= 0) ? itemRank[d] : -1;
+	if (r < 0)
+		return 0;
+	ranks.push_back(r);
+ }
+ sort(ranks.begin(), ranks.end());
+ ranks.erase(unique(ranks.begin(), ranks.end()), ranks.end());
+ return 1;
+}
+/******************************************************************************************
+ * Function: treeSupport
+ *
+ * Description:
+ *	Count the support of an itemset of large items in the FP-tree.
+ *	The chain of its least frequent item (the highest rank) is walked,
+ *	and a node counts if the other items are all among its ancestors;
+ *	as the ranks drop towards the root, a path is given up at the first
+ *	ancestor below the rank looked for.
+ *	Optionally the supports of the itemset extended by each other item
+ *	are counted too: the count of a node goes to each of its ancestors,
+ *	and the count of each of its descendants to the descendant.
+ *
+ * Invoked from:	
+ *	answerQuery()
+ *
+ * Input parameters:
+ *	ranks	-> The ranks of the itemset, ascending, at least one
+ *
+ * Output parameter:
+ *	ext	-> If not NULL, (*ext)[r] += support of the itemset plus rank r,
+ *		   for the ranks r not in the itemset
+ *
+ * Return:
+ *	The support of the itemset.
+ */
+int FPMiner::treeSupport(const vector<int> &ranks, vector<int> *ext)
+{
+ vector<FPTreeNode> stack;
+ FPTreeNode p, t;
+ childLink c;
+ int support = 0;
+ int n = ranks.size();
+ int r, j;
+
+ for (p = headerTableLink[ranks[n-1]]; p != NULL; p = p->hlink) {
+	PREFETCH(p->hlink);
+	j = n - 2;
+	for (t = p->parent; (j >= 0) && (t->parent != NULL); t = t->parent) {
+		r = itemRank[t->item];
+		if (r == ranks[j])
+			j--;
+		else if (r < ranks[j])
+			break;
+	}
+	if (j >= 0)
+		continue;
+	support += p->count;
+	if (ext == NULL)
+		continue;
+
+	for (t = p->parent; t->parent != NULL; t = t->parent)
+		(*ext)[itemRank[t->item]] += p->count;
+	stack.push_back(p);
+	while (!stack.empty()) {
+		t = stack.back();
+		stack.pop_back();
+		for (c = t->children; c != NULL; c = c->next) {
+			(*ext)[itemRank[c->node->item]] += c->node->count;
+			stack.push_back(c->node);
+		}
+	}
+ }
+ if (ext != NULL) {
+	for (j=0; j < n; j++)
+		(*ext)[ranks[j]] = 0;
+ }
+
+ return support;
+}
+/******************************************************************************************
+ * Function: queryStats
+ *
+ * Description:
+ *	The reply to a "stats" query: the number of queries answered,
+ *	the 50th and 99th percentiles of their latency (the upper bounds of
+ *	their histogram buckets), the max. latency and the histogram.
+ *
+ * Invoked from:	
+ *	answerQuery()
+ *	serve()
+ *
+ * Member variables (read only):
+ *	queryHist[], numQueries, queryMax
+ */
+void FPMiner::queryStats(string &reply)
+{
+ char buf[128];
+ long sum, p50, p99;
+ int b;
+
+ p50 = p99 = 0;
+ for (b=0, sum=0; (b < QUERY_BUCKETS) && (sum < numQueries); b++) {
+	sum += queryHist[b];
+	if ((p50 == 0) && (sum * 2 >= numQueries))
+		p50 = 2L << b;
+	if ((p99 == 0) && (sum * 100 >= numQueries * 99))
+		p99 = 2L << b;
+ }
+ sprintf(buf, "queries %ld p50 <%ldus p99 <%ldus max %ldus", numQueries, p50, p99, queryMax);
+ reply = buf;
+ for (b=0; b < QUERY_BUCKETS; b++) {
+	if (queryHist[b] > 0) {
+		sprintf(buf, " <%ldus:%ld", 2L << b, queryHist[b]);
+		reply += buf;
+	}
+ }
+
+ return;
+}
+/******************************************************************************************
+ * Function: ExtensionOrder
+ *
+ * Description:
+ *	Order of the ranks extending the itemset of a "top" query:
+ *	descending order of support, ties broken by the item IDs in ascending order.
+ */
+struct ExtensionOrder {
+	const int *support;	/* support[r] = support of the itemset plus rank r */
+	const int *item;	/* largeItem1[] */
+	const long long *key;	/* Item IDs of the dense items */
+	ExtensionOrder(const int *s, const int *i, const long long *k) : support(s), item(i), key(k) {}
+	bool operator()(int a, int b) const
+	{
+		if (support[a] != support[b])
+			return support[a] > support[b];
+		return key[item[a]] < key[item[b]];
+	}
+};
+/******************************************************************************************
+ * Function: answerQuery
+ *
+ * Description:
+ *	Answer one query line, the item IDs separated by blanks:
+ *	support <id> ...	-> "<support>" of the itemset, or "below <threshold>"
+ *				   if an item is not a large 1-item
+ *	top <n> <id> ...	-> "<id>:<support> ..." of the n items extending the itemset
+ *				   with the highest supports (all items for an empty itemset)
+ *	stats			-> The latency of the queries so far, see queryStats()
+ *	A wrong query gets "error <message>".
+ *
+ * Invoked from:	
+ *	serveStream()
+ *
+ * Functions to be invoked:
+ *	queryRanks(), treeSupport(), queryStats()
+ *
+ * Input parameters:
+ *	line	-> The query, cut up by strtok_r()
+ *
+ * Output parameter:
+ *	reply	-> The reply, one line without the newline
+ *
+ * Return:
+ *	1 if the latency of the query counts in the histogram, 0 for "stats" and errors.
+ */
+int FPMiner::answerQuery(char *line, string &reply)
+{
+ vector<int> ranks;
+ vector<int> ext;
+ vector<int> best;
+ char buf[64];
+ char *cmd, *tok, *save;
+ int n, r, i;
+
+ if ((cmd = strtok_r(line, " \t\r\n", &save)) == NULL) {
+	reply = "error empty query";
+	return 0;
+ }
+ if (strcmp(cmd, "stats") == 0) {
+	queryStats(reply);
+	return 0;
+ }
+
+ n = 0;
+ if (strcmp(cmd, "top") == 0) {
+	if (((tok = strtok_r(NULL, " \t\r\n", &save)) == NULL) || ((n = atoi(tok)) <= 0)) {
+		reply = "error top needs a number of items";
+		return 0;
+	}
+ } else if (strcmp(cmd, "support") != 0) {
+	reply = string("error unknown query ") + cmd + ", use support, top, stats, quit or shutdown";
+	return 0;
+ }
+ if (!queryRanks(&save, ranks)) {
+	sprintf(buf, "below %d", treeThreshold);
+	reply = buf;
+	return 1;
+ }
+
+ if (strcmp(cmd, "support") == 0) {
+	sprintf(buf, "%d", (ranks.empty()) ? numTrans : treeSupport(ranks, NULL));
+	reply = buf;
+	return 1;
+ }
+
+ if (ranks.empty())
+	ext.assign(support1, support1 + numLarge[0]);
+ else {
+	ext.assign(numLarge[0], 0);
+	treeSupport(ranks, &ext);
+ }
+ for (r=0; r < numLarge[0]; r++) {
+	if (ext[r] > 0)
+		best.push_back(r);
+ }
+ if (n > (int) best.size())
+	n = best.size();
+ partial_sort(best.begin(), best.begin() + n, best.end(), ExtensionOrder(&ext[0], largeItem1, dict.key));
+ reply.clear();
+ for (i=0; i < n; i++) {
+	sprintf(buf, "%s%lld:%d", (i > 0) ? " " : "", dict.key[largeItem1[best[i]]], ext[best[i]]);
+	reply += buf;
+ }
+
+ return 1;
+}
+/******************************************************************************************
+ * Function: serveStream
+ *
+ * Description:
+ *	Answer the queries of one client, one line each, until the end of its
+ *	input or a "quit" or "shutdown" line, and record their latencies.
+ *
+ * Invoked from:	
+ *	serve()
+ *
+ * Functions to be invoked:
+ *	answerQuery()
+ *
+ * Input parameters:
+ *	in	-> The queries
+ *	out	-> The replies
+ *
+ * Return:
+ *	1 if the client asks for a shutdown of the server, otherwise 0.
+ *
+ * Member variables:
+ *	queryHist[], numQueries, queryMax	-> The latencies
+ */
+int FPMiner::serveStream(FILE *in, FILE *out)
+{
+ chrono::steady_clock::time_point start;
+ string reply;
+ char line[QUERY_LINE];
+ char word[16];
+ long usecs;
+ int b;
+
+ while (fgets(line, sizeof(line), in) != NULL) {
+	if (strchr(line, '\n') == NULL) {
+		/* Skip the rest of an overlong line */
+		while ((b = fgetc(in)) != EOF && (b != '\n'))
+			;
+		fprintf(out, "error query longer than %d characters\n", QUERY_LINE - 2);
+		fflush(out);
+		continue;
+	}
+	if (sscanf(line, "%15s", word) == 1) {
+		if (strcmp(word, "quit") == 0)
+			return 0;
+		if (strcmp(word, "shutdown") == 0)
+			return 1;
+	}
+
+	start = chrono::steady_clock::now();
+	if (answerQuery(line, reply)) {
+		usecs = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+		for (b=0; (b < QUERY_BUCKETS - 1) && ((2L << b) <= usecs); b++)
+			;
+		queryHist[b]++;
+		numQueries++;
+		if (usecs > queryMax)
+			queryMax = usecs;
+	}
+	fprintf(out, "%s\n", reply.c_str());
+	fflush(out);
+ }
+
+ return 0;
+}
+#ifndef _WIN32
+/*
+ * SIGPIPE blocked in the calling thread for its lifetime, so that a write to
+ * a query client gone fails with EPIPE instead of ending the process; the
+ * handlers of the host stay as they are.  A SIGPIPE left pending is taken
+ * before the old signal mask is put back.
+ */
+struct PipeGuard {
+	sigset_t old;
+
+	PipeGuard()
+	{
+		sigset_t mask;
+
+		sigemptyset(&mask);
+		sigaddset(&mask, SIGPIPE);
+		pthread_sigmask(SIG_BLOCK, &mask, &old);
+	}
+	~PipeGuard()
+	{
+		sigset_t pending;
+		int sig;
+
+		sigpending(&pending);
+		if (sigismember(&pending, SIGPIPE) && !sigismember(&old, SIGPIPE)) {
+			sigemptyset(&pending);
+			sigaddset(&pending, SIGPIPE);
+			sigwait(&pending, &sig);
+		}
+		pthread_sigmask(SIG_SETMASK, &old, NULL);
+	}
+	PipeGuard(const PipeGuard &) = delete;
+	PipeGuard &operator=(const PipeGuard &) = delete;
+};
+#endif
+/******************************************************************************************
+ * Function: serve
+ *
+ * Description:
+ *	Query mode: keep the FP-tree built by build() resident and answer
+ *	itemset support queries from it, instead of mining (see answerQuery()).
+ *	The queries come from stdin if config.query is "-", otherwise from the
+ *	clients of a Unix socket of that name, one after another, until one
+ *	of them sends "shutdown".  The latency histogram is reported at the end.
+ *	On the socket, SIGPIPE is blocked in the serving thread only (see
+ *	PipeGuard), and the signal handlers of the process are left alone.
+ *	The tree holds the large 1-items only, and every transaction, so
+ *	item constraints are not taken.
+ *
+ * Invoked from:	
+ *	main()
+ *
+ * Functions to be invoked:
+ *	serveStream(), queryStats()
+ */
+void FPMiner::serve()
+{
+ string reply;
+#ifndef _WIN32
+ struct sockaddr_un addr;
+ FILE *in, *out;
+ int server, client, stop;
+#endif
+
+ if ((itemFlag != NULL) || (itemPrice != NULL)) {
+	throw FPError("query mode does not take item constraints");
+ }
+ if ((numLarge[0] > 0) && (root == NULL)) {
+	throw FPError("query mode needs the FP-tree in memory");
+ }
+ memset(queryHist, 0, sizeof(queryHist));
+ numQueries = 0;
+ queryMax = 0;
+
+ if (config.query == "-") {
+	report("\nserving queries on stdin\n");
+	fflush(stdout);
+	serveStream(stdin, stdout);
+ } else {
+#ifdef _WIN32
+	throw FPError("query mode on a socket needs Unix sockets");
+#else
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (config.query.size() >= sizeof(addr.sun_path)) {
+		throw FPError("Query socket name too long, " + config.query + ".");
+	}
+	strcpy(addr.sun_path, config.query.c_str());
+	if ((server = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+		throw FPError("Can't create the query socket.");
+	}
+	unlink(config.query.c_str());
+	if ((bind(server, (struct sockaddr *) &addr, sizeof(addr)) < 0) || (listen(server, 8) < 0)) {
+		close(server);
+		throw FPError(string("Can't listen on the query socket, ") + config.query + ".");
+	}
+	PipeGuard guard;	/* A client gone is not the end of the server */
+
+	report("\nserving queries on %s\n", config.query.c_str());
+	fflush(stdout);
+
+	stop = 0;
+	while (!stop) {
+		if ((client = accept(server, NULL, NULL)) < 0) {
+			if (errno == EINTR)
+				continue;
+			close(server);
+			throw FPError("Can't accept a query client.");
+		}
+		in = fdopen(client, "r");
+		out = fdopen(dup(client), "w");
+		if ((in == NULL) || (out == NULL)) {
+			close(server);
+			throw FPError("out of memory");
+		}
+		stop = serveStream(in, out);
+		fclose(in);
+		fclose(out);
+	}
+	close(server);
+	unlink(config.query.c_str());
+#endif
+ }
+
+ queryStats(reply);
+ report("%s\n", reply.c_str());
+ return;
+}
+/******************************************************************************************
+ * Function: VerifyMode
+ *
+ * Description:
+ *	The engines and modes checked by verifyEngines(), with their parameters.
+ *	A VERIFY_CONSTRAINED run takes the item constraints of the round, and a
+ *	VERIFY_STREAM run mines the sliding windows of the round by stream().
+ *	A VERIFY_ITEMS run writes the result file in item order from runs of
+ *	VERIFY_SORT_RUN itemsets, which is read back, and a VERIFY_RESUME run
+ *	is killed (its checkpoint log cut) and resumed by a new miner.
+ */
+typedef map<vector<long long>, int> ItemsetMap;
+
+#define VERIFY_MINE		0	/* build() and mine() */
+#define VERIFY_CONSTRAINED	1	/* The same, with include, exclude and maxPrice */
+#define VERIFY_STREAM		2	/* stream() */
+#define VERIFY_ITEMS		3	/* build(), mine() and writeResults() with outOrder items */
+#define VERIFY_RESUME		4	/* build() and mine() with a checkpoint, cut, then resumed */
+
+#define VERIFY_SORT_RUN		2	/* sortRun of VERIFY_ITEMS: many runs, merged in passes */
+
+typedef struct Verifymode {
+	const char *name;
+	int engine;
+	long memBudget;		/* Bytes */
+	int numThreads;
+	int relayout;
+	int shards;
+	int tokenizer;
+	int data;		/* DATA_xxx: the DB as text or compressed */
+	int job;		/* VERIFY_xxx */
+} VerifyMode;
+
+static const VerifyMode verifyModes[] = {
+	{"fptree",		ENGINE_FPTREE,		0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_MINE},
+	{"fptree-spill",	ENGINE_FPTREE,		4096,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_MINE},
+	{"fpgrowth",		ENGINE_FPGROWTH,	0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_MINE},
+	{"fpgrowth-spill",	ENGINE_FPGROWTH,	4096,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_MINE},
+	{"fpgrowth-norelayout",	ENGINE_FPGROWTH,	0,	0, 0, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_MINE},
+	{"fpgrowth-1thread",	ENGINE_FPGROWTH,	0,	1, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_MINE},
+	{"fpgrowth-scalar",	ENGINE_FPGROWTH,	0,	0, 1, 0, TOKENIZE_SCALAR,	DATA_TEXT, VERIFY_MINE},
+	{"fpgrowth-sse4",	ENGINE_FPGROWTH,	0,	0, 1, 0, TOKENIZE_SSE4,		DATA_TEXT, VERIFY_MINE},
+	{"fpgrowth-avx2",	ENGINE_FPGROWTH,	0,	0, 1, 0, TOKENIZE_AVX2,		DATA_TEXT, VERIFY_MINE},
+#ifdef HAVE_ZLIB
+	{"fpgrowth-gzip",	ENGINE_FPGROWTH,	0,	0, 1, 0, TOKENIZE_AUTO,		DATA_GZIP, VERIFY_MINE},
+#endif
+#ifdef HAVE_ZSTD
+	{"fpgrowth-zstd",	ENGINE_FPGROWTH,	0,	0, 1, 0, TOKENIZE_AUTO,		DATA_ZSTD, VERIFY_MINE},
+#endif
+#ifndef _WIN32
+	{"fpgrowth-shards",	ENGINE_FPGROWTH,	0,	0, 1, 3, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_MINE},
+	{"fptree-shards",	ENGINE_FPTREE,		0,	0, 1, 3, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_MINE},
+#endif
+	{"patricia",		ENGINE_PATRICIA,	0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_MINE},
+	{"patricia-spill",	ENGINE_PATRICIA,	4096,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_MINE},
+	{"bitset",		ENGINE_BITSET,		0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_MINE},
+	{"eclat",		ENGINE_ECLAT,		0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_MINE},
+	{"declat",		ENGINE_DECLAT,		0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_MINE},
+	{"fptree-constrained",	ENGINE_FPTREE,		0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_CONSTRAINED},
+	{"fpgrowth-constrained",	ENGINE_FPGROWTH,	0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_CONSTRAINED},
+#ifndef _WIN32
+	{"shards-constrained",	ENGINE_FPGROWTH,	0,	0, 1, 3, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_CONSTRAINED},
+#endif
+	{"patricia-constrained",	ENGINE_PATRICIA,	0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_CONSTRAINED},
+	{"bitset-constrained",	ENGINE_BITSET,		0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_CONSTRAINED},
+	{"eclat-constrained",	ENGINE_ECLAT,		0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_CONSTRAINED},
+	{"stream",		ENGINE_FPGROWTH,	0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_STREAM},
+	{"items",		ENGINE_FPGROWTH,	0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_ITEMS},
+	{"items-spill",		ENGINE_FPGROWTH,	4096,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_ITEMS},
+#ifndef _WIN32
+	{"items-shards",	ENGINE_FPGROWTH,	0,	0, 1, 3, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_ITEMS},
+#endif
+	{"fpgrowth-resume",	ENGINE_FPGROWTH,	0,	0, 1, 0, TOKENIZE_AUTO,		DATA_TEXT, VERIFY_RESUME}
+};
+#define NUM_VERIFY_MODES	((int) (sizeof(verifyModes) / sizeof(verifyModes[0])))
+
+/*
+ * Receiver of streamResults() in verify mode: add the itemset to the ItemsetMap;
+ * one already there is counted as a duplicate, in its support -1 entry.
+ */
+static void collectItemset(const long long *itemset, int k, int support, void *user)
+{
+ ItemsetMap *found = (ItemsetMap *) user;
+ vector<long long> key(itemset, itemset + k);
+
+ if (found->count(key))
+	(*found)[vector<long long>()]++;
+ else
+	(*found)[key] = support;
+ return;
+}
+
+/*
+ * Text of an itemset for the diffs of verify mode: "<item> <item> ... "
+ */
+static string itemsetText(const vector<long long> &itemset)
+{
+ string text;
+ size_t i;
+
+ for (i=0; i < itemset.size(); i++)
+	text += to_string(itemset[i]) + " ";
+ return text;
+}
+
+/*
+ * The oracle of verify mode: every itemset of at most maxK items and a
+ * support >= threshold in trans[] (each sorted), level by level: the
+ * candidates of size k join two large (k-1)-itemsets with the same first
+ * k-2 items and have all their (k-1)-subsets large, and are counted by
+ * a scan of the transactions.
+ */
+static void aprioriCount(const vector<vector<long long> > &trans, int threshold, int maxK, ItemsetMap &large)
+{
+ map<long long, int> count1;
+ vector<vector<long long> > level, next;
+ vector<long long> cand, sub;
+ int count;
+ size_t t, i, j, a, b;
+
+ for (t=0; t < trans.size(); t++) {
+	for (i=0; i < trans[t].size(); i++)
+		count1[trans[t][i]]++;
+ }
+ for (map<long long, int>::iterator it = count1.begin(); it != count1.end(); it++) {
+	if (it->second >= threshold) {
+		level.push_back(vector<long long>(1, it->first));
+		large[level.back()] = it->second;
+	}
+ }
+
+ for (int k=2; (k <= maxK) && (!level.empty()); k++) {
+	next.clear();
+	for (a=0; a < level.size(); a++) {
+		for (b=a+1; (b < level.size()) && (equal(level[a].begin(), level[a].end() - 1, level[b].begin())); b++) {
+			cand = level[a];
+			cand.push_back(level[b].back());
+			for (j=0; j < cand.size(); j++) {
+				sub = cand;
+				sub.erase(sub.begin() + j);
+				if (!large.count(sub))
+					break;
+			}
+			if (j < cand.size())
+				continue;
+			count = 0;
+			for (t=0; t < trans.size(); t++) {
+				if (includes(trans[t].begin(), trans[t].end(), cand.begin(), cand.end()))
+					count++;
+			}
+			if (count >= threshold) {
+				next.push_back(cand);
+				large[cand] = count;
+			}
+		}
+	}
+	level.swap(next);
+ }
+
+ return;
+}
+
+/*
+ * Drop from large the itemsets that break the item constraints of a verify
+ * round, as satisfies() does: an item of include (if any), none of exclude,
+ * and a total price (price[], 0 if not there) of at most maxPrice (if > 0).
+ * include and exclude are sorted.
+ */
+static void constrainItemsets(ItemsetMap &large, const vector<long long> &include, const vector<long long> &exclude,
+			      const map<long long, int> &price, int maxPrice)
+{
+ ItemsetMap::iterator it;
+ map<long long, int>::const_iterator pt;
+ int held, banned, total;
+ size_t i;
+
+ for (it = large.begin(); it != large.end(); ) {
+	held = banned = total = 0;
+	for (i=0; i < it->first.size(); i++) {
+		held |= binary_search(include.begin(), include.end(), it->first[i]);
+		banned |= binary_search(exclude.begin(), exclude.end(), it->first[i]);
+		if ((pt = price.find(it->first[i])) != price.end())
+			total += pt->second;
+	}
+	if (((!include.empty()) && (!held)) || (banned) || ((maxPrice > 0) && (total > maxPrice)))
+		large.erase(it++);
+	else
+		it++;
+ }
+ return;
+}
+
+/*
+ * Diff the itemsets found by a verify mode with those of the oracle, both sorted
+ * maps, and write the first three differences to the result file.
+ * Return the number of differences.
+ */
+static int diffItemsets(FILE *fp, const char *name, const ItemsetMap &oracle, ItemsetMap &found)
+{
+ ItemsetMap::const_iterator it, jt;
+ int shown = 0;
+
+ if ((jt = found.find(vector<long long>())) != found.end()) {
+	fprintf(fp, "  %s: %d itemsets found twice\n", name, jt->second);
+	found.erase(jt);
+	shown++;
+ }
+ it = oracle.begin();
+ jt = found.begin();
+ while ((it != oracle.end()) || (jt != found.end())) {
+	if ((jt == found.end()) || ((it != oracle.end()) && (it->first < jt->first))) {
+		if (shown++ < 3)
+			fprintf(fp, "  %s: missing %s(%d)\n", name, itemsetText(it->first).c_str(), it->second);
+		it++;
+	} else if ((it == oracle.end()) || (jt->first < it->first)) {
+		if (shown++ < 3)
+			fprintf(fp, "  %s: extra %s(%d)\n", name, itemsetText(jt->first).c_str(), jt->second);
+		jt++;
+	} else {
+		if ((it->second != jt->second) && (shown++ < 3))
+			fprintf(fp, "  %s: %s(%d), the count is %d\n", name,
+				itemsetText(jt->first).c_str(), jt->second, it->second);
+		it++;
+		jt++;
+	}
+ }
+ return shown;
+}
+
+/*
+ * Write the text of a verify DB to a data file, as it is or compressed (DATA_xxx).
+ */
+static void writeVerifyData(const string &name, const string &text, int format)
+{
+ FILE *fp;
+
+ (void) format;		/* Unused without ZLIB and ZSTD */
+#ifdef HAVE_ZLIB
+ if (format == DATA_GZIP) {
+	gzFile gz;
+
+	if (((gz = gzopen(name.c_str(), "wb")) == NULL) ||
+	    (gzwrite(gz, text.data(), text.size()) != (int) text.size()) || (gzclose(gz) != Z_OK)) {
+	        throw FPError(string("Can't write data file, ") + name + ".");
+	}
+	return;
+ }
+#endif
+#ifdef HAVE_ZSTD
+ if (format == DATA_ZSTD) {
+	vector<char> packed(ZSTD_compressBound(text.size()));
+	size_t n = ZSTD_compress(&packed[0], packed.size(), text.data(), text.size(), 3);
+
+	if (ZSTD_isError(n)) {
+	        throw FPError(string("Can't compress data file, ") + name + ".");
+	}
+	packed.resize(n);
+	if ((fp = fopen(name.c_str(), "wb")) == NULL) {
+	        throw FPError(string("Can't open data file, ") + name + ".");
+	}
+	fwrite(&packed[0], 1, n, fp);
+	fclose(fp);
+	return;
+ }
+#endif
+ if ((fp = fopen(name.c_str(), "w")) == NULL) {
+        throw FPError(string("Can't open data file, ") + name + ".");
+ }
+ fwrite(text.data(), 1, text.size(), fp);
+ fclose(fp);
+ return;
+}
+
+/*
+ * Parse a line of a result file, "<item> <item> ... (<support>)", into the
+ * item IDs in ascending order; return the support, or -1 if it is no itemset.
+ */
+static int parseItemset(const char *line, vector<long long> &itemset)
+{
+ const char *p;
+ char *end;
+
+ if ((p = strchr(line, '(')) == NULL)
+	return -1;
+ itemset.clear();
+ for (p = line; ; p = end) {
+	long long id = strtoll(p, &end, 10);
+	if (end == p)
+		break;
+	itemset.push_back(id);
+ }
+ sort(itemset.begin(), itemset.end());
+ return atoi(strchr(line, '(') + 1);
+}
+
+/*
+ * Read the result file of writeResults() back into found, and write to the
+ * result file of verify mode the first itemset out of the item order
+ * (outOrder items: smaller itemsets first, then ascending item IDs).
+ * Return the number of itemsets out of order.
+ */
+static int readItemsets(FILE *fp, const char *name, const string &resultName, ItemsetMap &found)
+{
+ FileOwner in(fopen(resultName.c_str(), "r"));
+ char line[4096];
+ vector<long long> itemset, last;
+ int support, unordered = 0;
+
+ if (in == NULL) {
+        throw FPError(string("Can't open result file, ") + resultName + ".");
+ }
+ while (fgets(line, sizeof(line), in.get()) != NULL) {
+	if ((support = parseItemset(line, itemset)) < 0)
+		continue;
+	if ((!last.empty()) && ((itemset.size() < last.size()) || ((itemset.size() == last.size()) && (itemset <= last)))) {
+		if (unordered++ == 0)
+			fprintf(fp, "  %s: %s(%d) out of item order\n", name, itemsetText(itemset).c_str(), support);
+	}
+	last = itemset;
+	if (found.count(itemset))
+		found[vector<long long>()]++;
+	else
+		found[itemset] = support;
+ }
+ return unordered;
+}
+
+/*
+ * Cut the checkpoint log of a verify job at a fraction of its length,
+ * as a job killed while it writes the log leaves it.
+ */
+static void cutCheckpointLog(const string &name, double fraction)
+{
+ FILE *fp;
+ vector<char> log;
+ char buf[4096];
+ size_t n;
+
+ if ((fp = fopen(name.c_str(), "rb")) == NULL)
+	return;
+ while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+	log.insert(log.end(), buf, buf + n);
+ fclose(fp);
+ if ((fp = fopen(name.c_str(), "wb")) == NULL) {
+        throw FPError(string("Can't open checkpoint file, ") + name + ".");
+ }
+ fwrite(log.data(), 1, (size_t) (log.size() * fraction), fp);
+ fclose(fp);
+ return;
+}
+
+/*
+ * Read the result file of stream() back: for each window, from its
+ * "# window <first>-<last>, threshold <t>" line, first - 1, last and t
+ * in bounds, and its itemsets in windows.
+ */
+static void readWindows(const string &name, vector<long> &bounds, vector<ItemsetMap> &windows)
+{
+ FileOwner fp(fopen(name.c_str(), "r"));
+ char line[4096];
+ vector<long long> itemset;
+ long first, last;
+ int threshold, support;
+
+ if (fp == NULL) {
+        throw FPError(string("Can't open result file, ") + name + ".");
+ }
+ while (fgets(line, sizeof(line), fp.get()) != NULL) {
+	if (sscanf(line, "# window %ld-%ld, threshold %d", &first, &last, &threshold) == 3) {
+		bounds.push_back(first - 1);
+		bounds.push_back(last);
+		bounds.push_back(threshold);
+		windows.push_back(ItemsetMap());
+		continue;
+	}
+	if ((windows.empty()) || ((support = parseItemset(line, itemset)) < 0))
+		continue;
+	if (windows.back().count(itemset))
+		windows.back()[vector<long long>()]++;
+	else
+		windows.back()[itemset] = support;
+ }
+ return;
+}
+
+/******************************************************************************************
+ * Function: verifyEngines
+ *
+ * Description:
+ *	Verify mode: mine config.verify random small DBs with every engine and
+ *	mode (spilled projected DBs, shards, the sequential build, no relayout,
+ *	each tokenizer, compressed DBs), and check each result, itemset by itemset,
+ *	against a brute-force level-wise count (Apriori without the tree) of the same DB.
+ *	The DBs vary in size, item IDs (up to 40 bits), density, threshold and
+ *	max. itemset size, and some transactions repeat an item, which counts
+ *	once; round r always makes the same DB.
+ *	Each round also draws item constraints (include, exclude, prices and
+ *	maxPrice), checked against the count without the itemsets they rule
+ *	out, and a window, batch and emitEvery for stream(), each window of
+ *	which is checked against the count of its transactions.
+ *	The result file in item order (outOrder items) is read back and checked
+ *	for its order too, and a job killed at a random point of its checkpoint
+ *	log is resumed and checked.
+ *	The result file gets the DB of each round, each difference found, and
+ *	for each mode the time it took over all the rounds.
+ *
+ * Invoked from:	
+ *	main()
+ *
+ * Functions to be invoked:
+ *	FPMiner::build(), FPMiner::mine(), FPMiner::streamResults()
+ *	FPMiner::stream()
+ *	FPMiner::writeResults()
+ *	aprioriCount(), constrainItemsets(), diffItemsets()
+ *	writeVerifyData(), readWindows(), readItemsets(), cutCheckpointLog()
+ *
+ * Input parameters:
+ *	config	-> config.verify rounds; config.outFile is the result file, and
+ *		   the prefix of the temporary files
+ *
+ * Return:
+ *	Number of runs whose result differs from the count.
+ */
+int verifyEngines(const FPConfig &config)
+{
+ vector<vector<long long> > trans;
+ vector<long long> ids, include, exclude;
+ vector<double> prob;
+ vector<double> secs(NUM_VERIFY_MODES, 0);
+ vector<int> failed(NUM_VERIFY_MODES, 0);
+ vector<long> bounds;
+ vector<ItemsetMap> windows;
+ map<long long, int> price;
+ ItemsetMap oracle, constrained, found, counted;
+ chrono::steady_clock::time_point start;
+ string dataName = config.outFile + ".verify.dat";
+ string priceName = config.outFile + ".verify.price";
+ string ckptName = config.outFile + ".verify.ckpt";
+ string dataFile[3] = {dataName, dataName + ".gz", dataName + ".zst"};	/* By DATA_xxx */
+ string text, includeList, excludeList, status;
+ FPConfig job;
+ FILE *fp, *db;
+ int numTrans, numItem, threshold, maxSize, maxK, maxPrice, window, batch, emitEvery, shown;
+ int round, m, i, j, w;
+ double u, cut;
+
+ if ((fp = fopen(config.outFile.c_str(), "w")) == NULL) {
+        throw FPError(string("Can't open result file, ") + config.outFile + ".");
+ }
+ for (round=0; round < config.verify; round++) {
+	/* A random DB; a few items are frequent, most are rare */
+	mt19937 rng(round + 1);
+	numTrans = 1 + rng() % 300;
+	numItem = 2 + rng() % 24;
+	ids.clear();
+	prob.clear();
+	for (i=0; i < numItem; i++) {
+		ids.push_back((rng() % 4 == 0) ? ((long long) rng() << 8) + i : 1 + i * 7 + rng() % 7);
+		u = (double) rng() / rng.max();
+		prob.push_back(0.02 + 0.5 * u * u);
+	}
+	trans.assign(numTrans, vector<long long>());
+	maxSize = 0;
+	for (j=0; j < numTrans; j++) {
+		for (i=0; i < numItem; i++) {
+			if ((double) rng() / rng.max() < prob[i])
+				trans[j].push_back(ids[i]);
+		}
+		shuffle(trans[j].begin(), trans[j].end(), rng);
+		if ((int) trans[j].size() > maxSize)
+			maxSize = trans[j].size();
+	}
+	job = config;
+	job.verify = 0;
+	job.verbose = 0;
+	job.expectedK = (rng() % 3 == 0) ? 1 + rng() % 4 : 0;
+	job.thresholdDecimal = 0.02 + 0.3 * ((double) rng() / rng.max());
+	job.numTrans = numTrans;
+	job.numItem = 0;
+	job.ruleFile.clear();
+	job.query.clear();
+	job.sample = 0;
+	job.counters = 0;
+	text.clear();
+	for (j=0; j < numTrans; j++) {
+		if ((!trans[j].empty()) && (rng() % 8 == 0))
+			trans[j].push_back(trans[j][rng() % trans[j].size()]);
+		text += to_string(trans[j].size());
+		for (i=0; i < (int) trans[j].size(); i++)
+			text += " " + to_string(trans[j][i]);
+		text += "\n";
+		sort(trans[j].begin(), trans[j].end());
+		trans[j].erase(unique(trans[j].begin(), trans[j].end()), trans[j].end());
+	}
+	for (i=0; i < 3; i++) {
+		for (m=0; (m < NUM_VERIFY_MODES) && (verifyModes[m].data != i); m++)
+			;
+		if (m < NUM_VERIFY_MODES)
+			writeVerifyData(dataFile[i], text, i);
+	}
+
+	/* The item constraints: up to two items to include and to exclude, prices of 0-4 */
+	include.clear();
+	exclude.clear();
+	price.clear();
+	for (i = rng() % 3; i > 0; i--)
+		include.push_back(ids[rng() % numItem]);
+	for (i = rng() % 3; i > 0; i--)
+		exclude.push_back(ids[rng() % numItem]);
+	sort(include.begin(), include.end());
+	sort(exclude.begin(), exclude.end());
+	maxPrice = (rng() % 2 == 0) ? 1 + rng() % 12 : 0;
+	for (i=0; i < numItem; i++) {
+		if (rng() % 4 != 0)
+			price[ids[i]] = rng() % 5;
+	}
+	if ((db = fopen(priceName.c_str(), "w")) == NULL) {
+	        throw FPError(string("Can't open price file, ") + priceName + ".");
+	}
+	for (map<long long, int>::iterator pt = price.begin(); pt != price.end(); pt++)
+		fprintf(db, "%lld %d\n", pt->first, pt->second);
+	fclose(db);
+	includeList.clear();
+	for (i=0; i < (int) include.size(); i++)
+		includeList += (i ? "," : "") + to_string(include[i]);
+	excludeList.clear();
+	for (i=0; i < (int) exclude.size(); i++)
+		excludeList += (i ? "," : "") + to_string(exclude[i]);
+
+	/* The oracle, at the threshold and size limit of pass1() */
+	threshold = job.thresholdDecimal * numTrans;
+	if (threshold == 0) threshold = 1;
+	maxK = ((job.expectedK <= 0) || (maxSize < job.expectedK)) ? maxSize : job.expectedK;
+	oracle.clear();
+	aprioriCount(trans, threshold, maxK, oracle);
+	fprintf(fp, "round %d: %d transactions, %d items, threshold %d, K %d: %d large itemsets\n",
+		round, numTrans, numItem, threshold, maxK, (int) oracle.size());
+	constrained = oracle;
+	constrainItemsets(constrained, include, exclude, price, maxPrice);
+	fprintf(fp, "  constrained: include %s, exclude %s, maxPrice %d: %d large itemsets\n",
+		itemsetText(include).c_str(), itemsetText(exclude).c_str(), maxPrice, (int) constrained.size());
+
+	/* The windows of stream() */
+	window = 1 + rng() % numTrans;
+	batch = 1 + rng() % 16;
+	emitEvery = (rng() % 2 == 0) ? 0 : 1 + rng() % window;
+	fprintf(fp, "  stream: window %d, batch %d, emitEvery %d\n", window, batch, emitEvery);
+
+	/* Where the resumed job was killed */
+	cut = (double) rng() / rng.max();
+	fprintf(fp, "  resume: checkpoint log cut at %.0f%%\n", cut * 100);
+
+	for (m=0; m < NUM_VERIFY_MODES; m++) {
+		job.engine = verifyModes[m].engine;
+		job.memBudget = verifyModes[m].memBudget;
+		job.numThreads = verifyModes[m].numThreads;
+		job.relayout = verifyModes[m].relayout;
+		job.shards = verifyModes[m].shards;
+		job.tokenizer = verifyModes[m].tokenizer;
+		job.dataFile = dataFile[verifyModes[m].data];
+		job.outFile = config.outFile + ".verify";
+		job.include.clear();
+		job.exclude.clear();
+		job.priceFile.clear();
+		job.maxPrice = 0;
+		job.window = 0;
+		job.batch = batch;
+		job.emitEvery = emitEvery;
+		job.outOrder = (verifyModes[m].job == VERIFY_ITEMS) ? OUT_ITEMS : config.outOrder;
+		job.sortRun = (verifyModes[m].job == VERIFY_ITEMS) ? VERIFY_SORT_RUN : config.sortRun;
+		job.checkpointFile = (verifyModes[m].job == VERIFY_RESUME) ? ckptName : string();
+		job.checkpointEvery = 0;
+		if (verifyModes[m].job == VERIFY_CONSTRAINED) {
+			job.include = includeList;
+			job.exclude = excludeList;
+			job.priceFile = priceName;
+			job.maxPrice = maxPrice;
+		}
+		if (verifyModes[m].job == VERIFY_STREAM)
+			job.window = window;
+		found.clear();
+		start = chrono::steady_clock::now();
+		if (verifyModes[m].job == VERIFY_RESUME) {
+			/* A run killed while it mines: the checkpoint log ends anywhere */
+			FPMiner miner(job);
+			miner.build();
+			miner.mine();
+			cutCheckpointLog(ckptName + ".log", cut);
+		}
+		{
+			FPMiner miner(job);
+			if (job.window > 0)
+				miner.stream();
+			else {
+				miner.build();
+				miner.mine();
+				miner.streamResults(collectItemset, &found);
+				if (verifyModes[m].job == VERIFY_ITEMS)
+					miner.writeResults();
+			}
+		}
+		secs[m] += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		if (verifyModes[m].job == VERIFY_RESUME) {
+			remove(ckptName.c_str());
+			remove((ckptName + ".log").c_str());
+		}
+
+		if (verifyModes[m].job == VERIFY_STREAM) {
+			/* Each window against the count of its transactions */
+			bounds.clear();
+			windows.clear();
+			readWindows(job.outFile, bounds, windows);
+			remove(job.outFile.c_str());
+			shown = 0;
+			for (w=0; w < (int) windows.size(); w++) {
+				vector<vector<long long> > in(trans.begin() + bounds[3*w], trans.begin() + bounds[3*w + 1]);
+
+				threshold = job.thresholdDecimal * (bounds[3*w + 1] - bounds[3*w]);
+				if (threshold == 0) threshold = 1;
+				counted.clear();
+				aprioriCount(in, threshold, (job.expectedK > 0) ? job.expectedK : maxSize, counted);
+				if (bounds[3*w + 2] != threshold) {
+					fprintf(fp, "  %s: window %ld-%ld has threshold %ld, not %d\n", verifyModes[m].name,
+						bounds[3*w] + 1, bounds[3*w + 1], bounds[3*w + 2], threshold);
+					shown++;
+				}
+				shown += diffItemsets(fp, verifyModes[m].name, counted, windows[w]);
+			}
+			if ((windows.empty()) || (bounds[bounds.size() - 2] != numTrans)) {
+				fprintf(fp, "  %s: the windows end at %ld, not %d\n", verifyModes[m].name,
+					windows.empty() ? 0 : bounds[bounds.size() - 2], numTrans);
+				shown++;
+			}
+		} else if (verifyModes[m].job == VERIFY_ITEMS) {
+			/* The result file, and what streamResults() handed out */
+			counted.clear();
+			shown = readItemsets(fp, verifyModes[m].name, job.outFile, counted);
+			remove(job.outFile.c_str());
+			shown += diffItemsets(fp, verifyModes[m].name, oracle, counted);
+			shown += diffItemsets(fp, verifyModes[m].name, oracle, found);
+		} else if (verifyModes[m].job == VERIFY_CONSTRAINED)
+			shown = diffItemsets(fp, verifyModes[m].name, constrained, found);
+		else
+			shown = diffItemsets(fp, verifyModes[m].name, oracle, found);
+		if (shown > 0)
+			failed[m]++;
+	}
+	for (i=0; i < 3; i++)
+		remove(dataFile[i].c_str());
+	remove(priceName.c_str());
+ }
+
+ fprintf(fp, "\n");
+ for (m=0, i=0; m < NUM_VERIFY_MODES; m++) {
+	status = (failed[m] == 0) ? string("ok") : to_string(failed[m]) + " rounds differ";
+	fprintf(fp, "%-20s %s, %.4f secs\n", verifyModes[m].name, status.c_str(), secs[m]);
+	if (config.verbose)
+		printf("%-20s %s, %.4f secs\n", verifyModes[m].name, status.c_str(), secs[m]);
+	i += failed[m];
+ }
+ fclose(fp);
+
+ return i;
+}
+
+
+/******************************************************************************************
+ * Function: main
+ *
+ * Description:
+ *	This function reads the config. file for six input parameters,
+ *	finds the frequent 1-itemsets, builds the initial FP-tree 
+ *	using the frequent 1-itemsets and 
+ *	peforms the FP-growth algorithm of the paper.
+ *	It measure both CPU and I/O time for build tree and mining.
+ *	Left out when fpt.cpp is compiled as a library (FPT_LIBRARY).
+ *
+ * Functions to be invoked: 
+ *	input()		-> Read config. file
+ *	FPMiner::build()	-> Find the frequent 1-itemsets and build the initial FP-tree
+ *	FPMiner::mine()		-> Start mining
+ *	FPMiner::writeResults()	-> Write the large itemsets and the association rules
+ *	FPMiner::stream()	-> Or mine a sliding window over a transaction stream
+ *	FPMiner::preflight()	-> Or estimate the results from a sample
+ *	FPMiner::serve()	-> Or answer itemset support queries from the FP-tree
+ *	verifyEngines()		-> Or check the engines against a brute-force count
+ *	FPMiner::workShard()	-> Or, run by mineShards(), mine one shard
+ *	
+ * Parameters:
+ *	Config. file name, or -shard and the arguments of workShard()
+ */
+#ifndef FPT_LIBRARY
+int main(int argc, char *argv[])
+{
+ FPConfig config;
+
+#ifdef __linux__
+ shardProgram = "/proc/self/exe";
+#else
+ shardProgram = argv[0];
+#endif
+
+ /* A shard worker of mineShards() -----------------*/
+ if ((argc == 8) && (strcmp(argv[1], "-shard") == 0)) {
+	config.verbose = 0;
+	try {
+		FPMiner miner(config);
+		miner.workShard(argv[2], argv[3], atoi(argv[4]), atoi(argv[5]), argv[6], atoi(argv[7]));
+	} catch (FPError &e) {
+		fprintf(stderr, "shard %s: %s\n", argv[3], e.what());
+		return 1;
+	} catch (bad_alloc &) {
+		fprintf(stderr, "shard %s: out of memory\n", argv[3]);
+		return 1;
+	}
+	return 0;
+ }
+
+ /* Usage ------------------------------------------*/
+ printf("\nFP-tree: Mining large itemsets using user support threshold\n\n");
+ if (argc != 2) {
+        printf("Usage: %s <config. file>\n\n", argv[0]);
+	printf("Content of config. file:\n");
+	printf("  Line 1: Upper limit of large itemsets size to be mined\n");
+	printf("  Line 2: Support threshold (normalized to [0, 1])\n");
+	printf("  Line 3: No. of different items in the DB\n");
+	printf("  Line 4: No. of transactions in the DB\n");
+	printf("  Line 5: File name of the DB\n");
+	printf("  Line 6: Result file name to store the large itemsets\n");
+	printf("  Optional lines: <name> <value>\n");
+	printf("    ruleFile <file>, minConf <c>, minLift <l>, numThreads <n>,\n");
+	printf("    engine auto|fptree|fpgrowth|patricia|bitset|eclat|declat,\n");
+	printf("    memBudget <MB>, verbose <0|1>,\n");
+	printf("    window <n>, batch <n>, emitEvery <n> (streaming, data file \"-\" = stdin),\n");
+	printf("    sample <n>, sampleThresholds <t,t,...>, verifySample <0|1> (preflight),\n");
+	printf("    checkpoint <file>, checkpointEvery <secs>,\n");
+	printf("    include <id,id,...>, exclude <id,id,...>, priceFile <file>, maxPrice <p>,\n");
+	printf("    relayout <0|1>, counters <0|1>, shards <n>,\n");
+	printf("    query <socket|-> (answer support queries instead of mining),\n");
+	printf("    tokenizer auto|scalar|sse4|avx2, outOrder support|items, sortRun <n>,\n");
+	printf("    verify <n> (check the engines on n random DBs instead of mining),\n");
+	printf("    hugePages auto|thp|off, numa <0|1>\n\n");
+        exit(1);
+ }
+
+ try {
+	/* read input parameters --------------------------*/
+	printf("input\n");
+	input(argv[1], &config);
+
+	FPMiner miner(config);
+	if (config.verify > 0) {
+		if (verifyEngines(config) > 0)
+			exit(1);
+	} else if (config.window > 0)
+		miner.stream();
+	else if (config.sample > 0)
+		miner.preflight();
+	else if (!config.query.empty()) {
+		miner.build();
+		miner.serve();
+	} else {
+		miner.build();
+		miner.mine();
+		miner.writeResults();
+	}
+ } catch (FPError &e) {
+	printf("%s\n", e.what());
+	exit(1);
+ } catch (bad_alloc &) {
+	printf("out of memory\n");
+	exit(1);
+ }
+
+ return 0;
+}
+#endif
@@ -0,0 +1,655 @@
+/* fpt.h
+ *
+ * Library interface of the FP-tree miner.
+ *
+ * A mining job is an FPMiner object constructed from an FPConfig.
+ * All the state of the job lives in the object, so any number of jobs
+ * can run in one process, each in its own thread:
+ *
+ *	FPConfig config;
+ *	input(configFile, &config);	-> or fill in the fields directly
+ *	FPMiner miner(config);
+ *	miner.build();			-> pass 1 and the initial FP-tree (or bitsets/tid-lists)
+ *	miner.mine();			-> the large k-itemsets, k = 2 to realK
+ *	miner.streamResults(callback, user);
+ *	miner.writeResults();		-> result file and rule file
+ *
+ * With config.window > 0, stream() replaces the three steps: the data file
+ * (or stdin, "-") is read as an endless stream and the large itemsets of
+ * the last config.window transactions are appended to the result file
+ * every config.emitEvery transactions.
+ *
+ * With config.sample > 0, preflight() replaces them: it estimates the number
+ * of large itemsets and the cost of each threshold from a random sample.
+ *
+ * With config.checkpointFile set, the fpgrowth engine saves the FP-tree after
+ * build() and flushes the itemsets found every config.checkpointEvery seconds;
+ * if the job is killed, build() of the same job resumes from the checkpoint.
+ *
+ * With config.query set, serve() replaces mine() and writeResults(): the
+ * FP-tree stays resident and answers itemset support queries, one per
+ * line, from stdin ("-") or a Unix socket.
+ *
+ * With config.verify > 0, verifyEngines() mines that many random DBs with
+ * every engine and mode, and checks them against a brute-force count.
+ *
+ * Mining leaves the FP-tree intact, so it can be mined again at a higher
+ * threshold with setThreshold() followed by mine().
+ *
+ * Errors (missing files, out of memory) are reported by throwing FPError;
+ * the scratch buffers of a job are still freed then.  A few of them are
+ * std::vectors, which throw std::bad_alloc when out of memory.
+ * Define FPT_LIBRARY when compiling fpt.cpp into a library to leave out main().
+ * Sharded mining (config.shards) is CLI-only: its workers are new runs of
+ * the fpt program, never forks of the host; in a library the DB is mined
+ * in the calling process instead.
+ */
+#ifndef FPT_H
+#define FPT_H
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<string>
+#include<vector>
+#include<map>
+#include<list>
+#include <atomic>
+#include <thread>
+#include <stdexcept>
+
+/***** Data Structure *****/
+/* Description:
+ *	Each node of an FP-tree is represented by a 'FPnode' structure.
+ *	Each node contains an item ID, count value of the item, and
+ *	node-link as stated in the paper.
+ *	
+ */
+typedef struct FPnode *FPTreeNode;	/* Pointer to a FP-tree node */
+
+typedef struct Childnode *childLink;	/* Pointer to children of a FP-tree node */
+
+/*
+ * Children of a FP-tree node
+ */
+typedef struct Childnode {
+	FPTreeNode node;	/* A child node of an item */
+	childLink next;		/* Next child */
+} ChildNode;
+
+/*
+ * A FP-tree node
+ */
+typedef struct FPnode {
+        int item;		/* ID of the item.  
+				   Value of ID is within the range [0, m-1]
+				   where m is the total number of different items in the database. */
+        int count;		/* Value of count of the item.
+				   This is the number of transactions containing items in the portion
+				   of the path reaching this node. */
+	int numPath;  		/* Number of leaf nodes in the subtree
+			           rooted at this node.  It is used to
+				   check whether there is only a single path 
+				   in the FPgrowth function. */
+
+	int numChildren;/*new added: for count of node's childre*/
+	int id;			/* Index of the node in its FP-tree, the root is 0.
+				   It addresses the per-node work arrays of traverse_list(). */
+
+	FPTreeNode parent;	/* Pointer to parent node */
+        childLink children;	/* Pointer to children */
+        FPTreeNode hlink;	/* Horizontal link to next node with same item */
+} FPNode;
+
+
+/*
+ * Patricia-style FP-tree: a run of single-child nodes with equal counts
+ * is collapsed into one node holding the items of the run.  A run is
+ * split when an insertion diverges in its middle.
+ */
+typedef struct Patnode *PatTreeNode;	/* Pointer to a Patricia FP-tree node */
+
+typedef struct Patlink *PatLink;	/* Pointer to a header table entry */
+
+/*
+ * An entry of the header table chain of an item: the position of the item in a run
+ */
+typedef struct Patlink {
+	PatTreeNode node;	/* Node whose run holds the item */
+	int pos;		/* Position of the item in the run */
+	PatLink next;		/* Next entry of the same item */
+} PatLinkNode;
+
+/*
+ * A Patricia FP-tree node.  The node, its links[] and items[] (and the header
+ * entries of its items, when the node is created by an insertion) are one allocation.
+ */
+typedef struct Patnode {
+	int numItems;		/* Length of the run, 0 for the root */
+	int count;		/* Count of every item of the run */
+	PatTreeNode parent;	/* Pointer to parent node */
+	PatTreeNode children;	/* First child */
+	PatTreeNode sibling;	/* Next child of the parent */
+	PatLink *links;		/* links[i] = header table entry of items[i] */
+	int *items;		/* items[i] = rank of the (i+1)th item of the run, ascending */
+} PatNode;
+
+/*
+ * A list to store large itemsets in descending order of their supports.
+ * It stores all the itemsets of supports >= threshold.
+ */
+typedef struct Itemsetnode *LargeItemPtr;
+typedef struct Itemsetnode {
+	int support;
+	int *itemset;
+	LargeItemPtr next;
+} ItemsetNode;
+
+/*
+ * Dictionary of the item IDs of the DB: maps each item ID, which may be
+ * sparse and up to 64 bits (e.g. SKUs), to a dense item number in [0, numItem).
+ * Open addressing with linear probing; the table size is a power of 2.
+ */
+typedef struct Itemdict {
+	long long *key;		/* key[i] = item ID of dense item i */
+	int numKeys;		/* Number of items */
+	int sizeKeys;		/* Capacity of key[] */
+	int *slot;		/* slot[h] = dense item stored at slot h, or -1 */
+	int size;		/* Number of slots */
+} ItemDict;
+
+/* Huge page policies of the big blocks of memory (FP-tree arenas, bitsets, tid-lists,
+   the buffers of the reader and of the ring of batches) */
+#define HUGE_OFF	0	/* Small pages */
+#define HUGE_THP	1	/* Transparent huge pages */
+#define HUGE_AUTO	2	/* Explicit huge pages of the hugetlbfs pool, else transparent ones */
+
+/* Pages a big block of memory got */
+#define PAGES_SMALL	0	/* calloc()'ed */
+#define PAGES_THP	1	/* mmap()'ed and advised to transparent huge pages */
+#define PAGES_HUGETLB	2	/* mmap()'ed from the hugetlbfs pool */
+#define NUM_PAGES	3
+extern const char *pagesName[NUM_PAGES];
+
+/*
+ * A big block of memory, see bigAlloc().
+ */
+typedef struct Bigblock {
+	void *base;		/* The block, NULL = none */
+	size_t bytes;		/* Its size, rounded up to huge pages if on them */
+	int pages;		/* PAGES_xxx */
+} BigBlock;
+
+/* Formats of a compressed DB, told by their magic bytes */
+#define DATA_TEXT	0	/* Not compressed */
+#define DATA_GZIP	1	/* gzip, needs HAVE_ZLIB */
+#define DATA_ZSTD	2	/* zstd, needs HAVE_ZSTD */
+
+/* Tokenizers of the text of the DB */
+#define TOKENIZE_AUTO	0	/* The fastest one the CPU has */
+#define TOKENIZE_SCALAR	1	/* One byte at a time */
+#define TOKENIZE_SSE4	2	/* SSE4.1: an integer of up to 16 digits converted at once */
+#define TOKENIZE_AVX2	3	/* AVX2: and the delimiters of 32 bytes found at once */
+#define NUM_TOKENIZE	4
+extern const char *tokenizerName[NUM_TOKENIZE];
+
+/*
+ * A reader scanning the transactions of the DB.
+ * The text is read a block at a time and cut into integers (tokens) by the
+ * tokenizer, a block ahead of the transactions.
+ * A compressed DB is decompressed by a thread of the reader into a pipe,
+ * which the text is read from.
+ * A reader left open, by an FPError thrown while it reads, is released
+ * when it goes out of scope.
+ */
+typedef struct Transreader {
+	FILE *fp;		/* The database file, or the pipe from the inflater */
+	int *items;		/* Dense items of the current transaction */
+	int size;		/* Number of items that fit in items[] */
+	ItemDict *dict;		/* Dictionary of the item IDs */
+	int grow;		/* Add unknown item IDs to the dictionary, otherwise skip them */
+	int tokenizer;		/* The tokenizer, TOKENIZE_xxx but auto */
+	char *buf;		/* Text read ahead */
+	int bufLen;		/* Bytes in buf[] */
+	int bufPos;		/* Bytes of buf[] cut into tokens */
+	long long *tokens;	/* The integers of buf[] */
+	int numTokens;		/* Number of tokens[] */
+	int tokenPos;		/* Next token of the transactions */
+	int atEnd;		/* The text ends, or a byte that is no integer was met */
+	FILE *src;		/* The compressed database file, NULL = not compressed */
+	std::thread *inflater;	/* Thread decompressing src into the pipe */
+	char error[128];	/* Error of the inflater, empty = none */
+	BigBlock block;		/* The memory of tokens[], buf[] and items[] to begin with */
+	BigBlock itemBlock;	/* The memory of items[] once they outgrow block, base NULL before */
+	int hugePages;		/* Huge page policy of the blocks, HUGE_xxx */
+
+	Transreader() : fp(NULL), items(NULL), buf(NULL), tokens(NULL), src(NULL), inflater(NULL)
+	{
+		error[0] = '\0';
+		memset(&block, 0, sizeof(block));
+		memset(&itemBlock, 0, sizeof(itemBlock));
+	}
+	~Transreader();
+} TransReader;
+
+/*
+ * A batch of transactions read for buildTree(): the large items of each
+ * transaction, sorted by rank, with their ranks.
+ */
+typedef struct Transbatch {
+	int *items;		/* The items of the transactions, one after another */
+	int *ranks;		/* ranks[i] = rank of items[i] */
+	int *len;		/* len[t] = number of items of transaction t */
+	int numTrans;		/* Number of transactions in the batch */
+	int sizeItems;		/* Capacity of items[] and ranks[] */
+	BigBlock block;		/* The memory of items[] and ranks[] once they outgrow the
+				   block of the ring, base NULL before */
+} TransBatch;
+
+#define RING_SLOTS	8	/* Batches of the ring between the reader and the inserter */
+#define BATCH_TRANS	1024	/* Max. number of transactions of a batch */
+
+/*
+ * The ring of batches between the reader thread and the inserter of a
+ * pipelined buildTree().  The reader fills slot[head % RING_SLOTS] and
+ * the inserter empties slot[tail % RING_SLOTS]; the reader waits while
+ * the ring is full, the inserter while it is empty.
+ * The buffers of the batches are one big block, freed with the ring.
+ */
+typedef struct Transring {
+	TransBatch slot[RING_SLOTS];
+	std::atomic<long> head;	/* Batches filled by the reader */
+	std::atomic<long> tail;	/* Batches emptied by the inserter */
+	std::atomic<int> done;	/* The reader has filled its last batch */
+	std::atomic<int> stop;	/* The inserter gives up the tree: the reader is to stop */
+	long readStalls;	/* Times the reader found the ring full */
+	long insertStalls;	/* Times the inserter found the ring empty */
+	long numRead;		/* Transactions the reader read */
+	double readSecs;	/* Time the reader spent reading */
+	double insertSecs;	/* Time the inserter spent inserting */
+	std::string error;	/* Error of the reader, empty = none */
+	BigBlock block;		/* The memory of the batches */
+
+	Transring() : head(0), tail(0), done(0), stop(0), readStalls(0), insertStalls(0), numRead(0), readSecs(0), insertSecs(0)
+	{
+		memset(slot, 0, sizeof(slot));
+		memset(&block, 0, sizeof(block));
+	}
+	~Transring();
+} TransRing;
+
+/*
+ * A member of an equivalence class of the vertical (Eclat/dEclat) engine:
+ * an itemset given by the class prefix plus one item, with its
+ * sorted tid-list or diffset.
+ */
+typedef struct Tidlist {
+	int item;		/* Last item of the itemset */
+	int support;		/* Support of the itemset */
+	int size;		/* Number of tids */
+	int *tids;		/* Tid-list or diffset, in ascending order */
+} TidList;
+
+/*
+ * A hash index over the large k-itemsets of one size k.
+ * Open addressing with linear probing; the table size is a power of 2
+ * and at least twice the number of itemsets, so a lookup is O(1).
+ */
+typedef struct Itemsetindex {
+	int size;		/* Number of slots, a power of 2 */
+	LargeItemPtr *slot;	/* slot[h] = itemset stored at slot h, or NULL */
+} ItemsetIndex;
+
+/*
+ * Sorted runs of k-itemsets in a temporary file, for the OUT_ITEMS order:
+ * each record is the k item IDs in ascending order and the support, as
+ * long longs, and run i holds the records [bound[i], bound[i+1]).
+ * All the runs of one size share the file, so merging them takes no more
+ * file descriptors as they grow in number.
+ */
+typedef struct Runfile {
+	FILE *fp;			/* The temporary file, NULL = no runs yet */
+	std::vector<long> bound;	/* First record of each run, and the end of the last */
+
+	Runfile() : fp(NULL) {}
+	~Runfile() { if (fp != NULL) fclose(fp); }
+	Runfile(const Runfile &) = delete;
+	Runfile &operator=(const Runfile &) = delete;
+} RunFile;
+
+/*
+ * The conditional pattern base of an item: the prefix paths of its
+ * nodes in an FP-tree, kept in flat buffers reused from one base to the next.
+ */
+typedef struct Condbase {
+	int *support;		/* support[r] = support of rank r in the base */
+	int *ranks;		/* The prefix paths, each in ascending order of rank, one after another */
+	int *pathLen;		/* pathLen[i] = number of ranks of path i */
+	int *pathCount;		/* pathCount[i] = count of path i */
+	int numPaths;		/* Number of paths */
+	int numRanks;		/* Number of ranks in ranks[] */
+	int sizeRanks;		/* Capacity of ranks[] */
+	int sizePaths;		/* Capacity of pathLen[] and pathCount[] */
+} CondBase;
+
+/*
+ * A node of a conditional FP-tree of FP-growth.  The layout is chosen per
+ * tree: Rank and Count are the narrowest types that hold the ranks and the
+ * counts of the tree.  There is no numPath, numChildren or id, and a link is
+ * the index of a node in the array of the tree, 0 (the root) for none.
+ */
+template<class Rank, class Count> struct CondNode {
+	Count count;		/* Count of the node */
+	Rank rank;		/* Rank of the item */
+	unsigned int parent;	/* Parent node */
+	unsigned int child;	/* First child */
+	unsigned int sibling;	/* Next child of the parent */
+	unsigned int hlink;	/* Next node of the same rank */
+};
+
+/*
+ * A conditional FP-tree: its nodes are one array, freed at once
+ * when the tree goes out of scope.
+ */
+template<class Rank, class Count> struct CondTree {
+	CondNode<Rank, Count> *node;	/* node[0] = root */
+	int numNodes;		/* Nodes used, root included */
+	int sizeNodes;		/* Nodes allocated */
+	unsigned int *header;	/* header[r] = first node of rank r, 0 = none */
+
+	CondTree() : node(NULL), numNodes(0), sizeNodes(0), header(NULL) {}
+	~CondTree() { free(node); free(header); }
+private:
+	CondTree(const CondTree &);	/* Not copyable */
+	CondTree &operator=(const CondTree &);
+};
+
+/***** Configuration *****/
+
+/* Mining engines */
+#define ENGINE_AUTO	0	/* Choose by chooseEngine() */
+#define ENGINE_FPTREE	1	/* FP-tree */
+#define ENGINE_BITSET	2	/* Bitset of transactions of each large 1-item */
+#define ENGINE_ECLAT	3	/* Vertical tid-lists (Eclat) */
+#define ENGINE_DECLAT	4	/* Vertical diffsets (dEclat) */
+#define ENGINE_FPGROWTH	5	/* FP-tree mined by FP-growth with conditional FP-trees */
+#define ENGINE_PATRICIA	6	/* Patricia FP-tree mined by FP-growth */
+#define NUM_ENGINE	7
+extern const char *engineName[NUM_ENGINE];
+
+/* Orders of the itemsets of a size in the result file */
+#define OUT_SUPPORT	0	/* ItemsetOrder: descending support */
+#define OUT_ITEMS	1	/* Ascending item IDs, by an external merge sort */
+
+/*
+ * Parameters of a mining job, as read from a config. file by input().
+ */
+typedef struct FPconfig {
+	int expectedK;		/* User input upper limit of itemset size to be mined */
+	float thresholdDecimal;	/* Normalized support threshold, range: (0, 1] */
+	int numItem;		/* Number of items in the database (a hint, found by the first scan) */
+	int numTrans;		/* Number of transactions in the database (a hint, found by the first scan) */
+	std::string dataFile;	/* File name of the database */
+	std::string outFile;	/* File name to store the result of mining */
+	std::string ruleFile;	/* File name to store the association rules, empty = no rules */
+	float minConf;		/* Minimum confidence of a rule */
+	float minLift;		/* Minimum lift of a rule */
+	int numThreads;		/* Number of worker threads, 0 = one per CPU */
+	int engine;		/* The mining engine, ENGINE_xxx */
+	long memBudget;		/* Memory budget of an FP-tree in bytes, 0 = no limit */
+	int verbose;		/* Report progress and timing on stdout */
+	int window;		/* Streaming: number of transactions in the sliding window, 0 = no streaming */
+	int batch;		/* Streaming: transactions inserted/expired at a time */
+	int emitEvery;		/* Streaming: transactions between two outputs, 0 = window */
+	int sample;		/* Preflight: number of transactions sampled, 0 = no preflight */
+	std::string sampleThresholds;	/* Preflight: thresholds to estimate, comma separated */
+	int verifySample;	/* Preflight: count the candidate itemsets in the full DB */
+	std::string checkpointFile;	/* File name of the checkpoint, empty = no checkpoints */
+	int checkpointEvery;	/* Seconds between two checkpoints */
+	std::string include;	/* Item IDs, comma separated: an itemset must hold one of them, empty = any */
+	std::string exclude;	/* Item IDs, comma separated: an itemset must hold none of them */
+	std::string priceFile;	/* File of "<item ID> <price>" lines, for maxPrice */
+	float maxPrice;		/* Max. total price of an itemset, 0 = no limit */
+	int relayout;		/* Lay the built FP-tree out in depth-first order */
+	int counters;		/* Count the node visits and simulated cache misses of mining */
+	int shards;		/* Mine the DB in this many worker processes, 0 or 1 = in this process */
+	std::string query;	/* Query mode: Unix socket to serve queries on, "-" = stdin, empty = no query mode */
+	int tokenizer;		/* Tokenizer of the text of the DB, TOKENIZE_xxx */
+	int outOrder;		/* Order of the itemsets of a size in the result file, OUT_xxx */
+	int sortRun;		/* OUT_ITEMS: itemsets sorted in memory at a time */
+	int verify;		/* Verify mode: random DBs to check the engines on, 0 = no verify mode */
+	int hugePages;		/* Huge pages of the FP-tree arenas and the bitsets, HUGE_xxx */
+	int numa;		/* Bind the shard workers to NUMA nodes */
+
+	FPconfig()
+	{
+		expectedK = 0;
+		thresholdDecimal = 0;
+		numItem = 0;
+		numTrans = 0;
+		minConf = 0;
+		minLift = 0;
+		numThreads = 0;
+		engine = ENGINE_AUTO;
+		memBudget = 0;
+		verbose = 1;
+		window = 0;
+		batch = 64;
+		emitEvery = 0;
+		sample = 0;
+		verifySample = 0;
+		checkpointEvery = 600;
+		maxPrice = 0;
+		relayout = 1;
+		counters = 0;
+		shards = 0;
+		tokenizer = TOKENIZE_AUTO;
+		outOrder = OUT_SUPPORT;
+		sortRun = 1 << 20;
+		verify = 0;
+		hugePages = HUGE_AUTO;
+		numa = 1;
+	}
+} FPConfig;
+
+/*
+ * Error of a mining job.
+ */
+class FPError : public std::runtime_error {
+public:
+	FPError(const std::string &message) : std::runtime_error(message) {}
+};
+
+/*
+ * Flags of an item under the item constraints of FPConfig
+ */
+#define ITEM_INCLUDE	1	/* One of the items an itemset must hold */
+#define ITEM_EXCLUDE	2	/* An item no itemset may hold */
+
+/*
+ * Query latency histogram of FPMiner::serve(): bucket b counts the queries
+ * answered in [2^b, 2^(b+1)) microseconds, bucket 0 also the faster ones.
+ */
+#define QUERY_BUCKETS	32
+
+/*
+ * Receiver of the large itemsets of FPMiner::streamResults():
+ * itemset[0..k-1] = the item IDs of the DB in ascending order, its support
+ * and the user pointer given to streamResults().
+ */
+typedef void (*ItemsetCallback)(const long long *itemset, int k, int support, void *user);
+
+void input(const char *configFile, FPConfig *config);
+int setOption(FPConfig *config, const char *name, const char *value);
+int verifyEngines(const FPConfig &config);	/* Check every engine against a brute-force count */
+
+/***** Miner *****/
+class FPMiner {
+public:
+	FPMiner(const FPConfig &config);
+	~FPMiner();
+
+	void build();
+	void mine();
+	void streamResults(ItemsetCallback callback, void *user);
+	void writeResults();
+	void stream();			/* Mine a sliding window over a transaction stream */
+	void preflight();		/* Estimate the results of thresholds from a sample */
+	void serve();			/* Answer itemset support queries from the resident FP-tree */
+	void setThreshold(double thresholdDecimal);	/* Re-mine the FP-tree at a higher threshold */
+	void workShard(const char *stateName, const char *dbName, int lo, int hi,
+			const char *resultName, int node);	/* The work of a shard worker of the fpt program */
+
+	int numLargeItemsets(int k) const;	/* Number of large k-itemsets found */
+	int maxItemsetSize() const { return realK; }
+
+private:
+	FPMiner(const FPMiner &);		/* Not copyable */
+	FPMiner &operator=(const FPMiner &);
+
+	FPConfig config;		/* Parameters of the job */
+
+	LargeItemPtr *largeItemset;	/* largeItemset[k-1] = array of large k-itemsets */
+	int *numLarge;			/* numLarge[k-1] = no. of large k-itemsets found. */
+	int *support1;			/* Support of 1-itemsets */
+	int *largeItem1;		/* 1-itemsets */
+	int *itemRank;			/* itemRank[item] = index of a large 1-item in largeItem1[], -1 if not large */
+
+	FPTreeNode root;		/* Initial FP-tree */
+	FPTreeNode *headerTableLink;	/* Corresponding header table */
+	PatTreeNode patRoot;		/* Initial Patricia FP-tree */
+	PatLink *patHeader;		/* Corresponding header table */
+
+	int expectedK;			/* User input upper limit of itemset size to be mined */
+	int realK;			/* Actual upper limit of itemset size can be mined */
+	int threshold;			/* User input support threshold */
+	int treeThreshold;		/* Support threshold the FP-tree was built with */
+	int numItem;			/* Number of items in the database, found by pass1() */
+	int numTrans;			/* Number of transactions in the database, found by pass1() */
+	ItemDict dict;			/* Item IDs of the database <-> dense items */
+	int engine;			/* The mining engine */
+	ItemsetIndex *itemsetIndex;	/* itemsetIndex[k-1] = hash index over large k-itemsets */
+	RunFile *itemRuns;		/* OUT_ITEMS: itemRuns[k-1] = k-itemsets spilled while mining, NULL = none */
+	long numSpilled;		/* Number of itemsets in itemRuns */
+	int spillRuns;			/* Spill the itemsets of each shard and partition to itemRuns */
+
+	long treeBytes;			/* Memory used by the FP-tree being built */
+	int treeOverflow;		/* The FP-tree being built exceeds the memory budget */
+	int numNodes;			/* Number of nodes of the FP-tree being built or mined, root included */
+	int zeroNodes;			/* Streaming: nodes whose count dropped to zero since the last pruning */
+
+	unsigned long long *tidBits;	/* tidBits[r * numWords ...] = bitset of the transactions containing large 1-item r */
+	int numWords;			/* Number of 64-bit words of a bitset */
+	TidList *tidLists;		/* tidLists[r] = tid-list of large 1-item r */
+
+	CondBase condBase;		/* Conditional pattern base being built */
+
+	int **sampleTrans;		/* sampleTrans[i] = dense items of sampled transaction i */
+	int *sampleLen;			/* sampleLen[i] = number of items of sampled transaction i */
+	int numSample;			/* Number of sampled transactions */
+
+	FILE *ckptLog;			/* Log of the itemsets flushed, NULL = not checkpointing */
+	int ckptRank;			/* The items of rank >= ckptRank are mined, -1 = no checkpoint */
+	LargeItemPtr *ckptMark;		/* ckptMark[k-1] = first large k-itemset already flushed */
+	time_t ckptTime;		/* Time of the last checkpoint */
+
+	unsigned char *itemFlag;	/* itemFlag[item] = ITEM_xxx flags of the item constraints, NULL = none */
+	float *itemPrice;		/* itemPrice[item] = price of the item, NULL = no price limit */
+
+	FPNode *nodeArena;		/* Nodes of the initial FP-tree after relayoutTree(), NULL = malloc'ed one by one */
+	ChildNode *childArena;		/* Their children entries */
+	BigBlock nodeBlock;		/* The memory of nodeArena */
+	BigBlock childBlock;		/* The memory of childArena */
+	BigBlock bitBlock;		/* The memory of tidBits */
+	BigBlock tidBlock;		/* The memory of the tids of tidLists */
+	unsigned long long *simTag;	/* Counters: lines of the simulated cache, NULL = no counters */
+	long walkSteps;			/* Counters: nodes visited building pattern bases */
+	long walkMisses;		/* Counters: simulated cache misses of these visits */
+	int minRank;			/* Only the itemsets whose last item has rank >= minRank are mined */
+	long queryHist[QUERY_BUCKETS];	/* Query mode: latency histogram */
+	long numQueries;		/* Query mode: queries answered */
+	long queryMax;			/* Query mode: max. latency in microseconds */
+
+	std::map<std::string, int> mp;
+
+	void report(const char *format, ...);
+	void destroy();
+	childLink newTreeNode();
+	void insert_tree(int *freqItemP, int *indexList, int count, int ptr, int length,
+				FPTreeNode T, FPTreeNode *headerTableLink, int *path);
+	void loadConstraints();
+	int satisfies(const int *itemset, int k);
+	void pass1();
+	int buildTree(FPTreeNode& root);
+	int readBatch(TransReader *reader, TransBatch *batch, int maxTrans);
+	void insertBatch(TransBatch *batch, FPTreeNode root);
+	void readStage(TransRing *ring);
+	void relayoutTree();
+	void countAccess(const void *addr);
+	void show_time(int i);
+	void combination_node(FPTreeNode pnode, int cc, std::map<std::string, int> & mp, int maxK);
+	void loop_same_items(FPTreeNode hnode, int numRank);
+	void fpGrowth(FPTreeNode *header, int numRank, int *itemset, int k);
+	int pruneCond(int r, int suffixIncl, float suffixPrice, float *budget);
+	void growCond(int r, int support, int *itemset, int k, float budget);
+	template<class Rank, class Count> void condTreeBase(CondTree<Rank, Count> *tree, int r);
+	template<class Rank, class Count> void buildCondTree(CondTree<Rank, Count> *tree, int numRank, float budget);
+	template<class Rank, class Count> void mineCondTree(int numRank, int *itemset, int k, float budget);
+	template<class Rank, class Count> void condGrowth(CondTree<Rank, Count> *tree, int numRank, int *itemset, int k);
+	void init_list(FPTreeNode p, FPTreeNode *queue, int *tail, int *residual, int *pending);
+	void traverse_list(FPTreeNode root, int maxK);
+	void clearLargeItemsets(int all);
+	void addLargeItemset(int *itemset, int k, int support);
+	void sortLargeItemsets();
+	void storeLargeItemsets(std::map<std::string, int> & mp, int *suffix, int suffixLen);
+	int nextRecord(FILE *src, TransReader *reader, int *ranks);
+	void mineProjected(FILE *src, int numRank, int *suffix, int suffixLen, int suffixSupport);
+	void partitionAndMine(FILE *src, int numRank, int *localSupport, int *suffix, int suffixLen);
+	void mineShard(FILE *src, int lo, int hi, const char *resultName);
+	void saveShardState(const char *name);
+	void loadShardState(const char *name);
+	void mineShards();
+	int queryRanks(char **save, std::vector<int> &ranks);
+	int treeSupport(const std::vector<int> &ranks, std::vector<int> *ext);
+	void queryStats(std::string &reply);
+	int answerQuery(char *line, std::string &reply);
+	int serveStream(FILE *in, FILE *out);
+	void itemKeys(const int *itemset, int k, long long *keys);
+	void writeItemsets(FILE *fp);
+	int cutRun(LargeItemPtr *list, int k, int max, std::vector<long long> &rec, std::vector<int> &order);
+	void spillRun(RunFile *run, LargeItemPtr *list, int k, int max);
+	void spillItemsets(int all);
+	void mergeItemsets(int k, ItemsetCallback callback, void *user);
+	void writeSortedItemsets(FILE *fp);
+	void writeLargeItemsets();
+	void verifyCandidates(std::vector<int> &cand, std::vector<int> &candK, std::vector<int> &candSupport);
+	void readTreeNode(FILE *fp, FPTreeNode parent, FPTreeNode *tail);
+	void saveTree();
+	int loadCheckpoint();
+	void openCheckpointLog();
+	void saveProgress(int doneRank);
+	void expireTrans(int *items, int n);
+	void pruneTree();
+	void emitWindow(FILE *fp, long first, long last);
+	void buildItemsetIndex();
+	LargeItemPtr findItemset(int *itemset, int k);
+	void genRulesWorker(std::vector<LargeItemPtr> *sets, std::vector<int> *sizes, std::vector<std::string> *out,
+				std::atomic<int> *nextChunk, std::atomic<long> *numRules);
+	void genRules();
+	void buildBitsets();
+	void extendBitset(const unsigned long long *prefix, int last, int k, int *itemset, unsigned long long *stack);
+	void mineBitsets();
+	void buildTidLists();
+	void extendEclat(TidList *cls, int n, int k, int *itemset, int isDiff);
+	void mineEclat();
+	void chooseEngine();
+	PatTreeNode newPatNode(PatTreeNode parent, int *ranks, int n, int count, PatLink *header);
+	void splitPatNode(PatTreeNode node, int d);
+	void insertPatTree(PatTreeNode root, int *ranks, int n, int count, PatLink *header);
+	int buildPatTree();
+	void patBase(PatLink hlink, int numRank);
+	void patGrowth(PatLink *header, int numRank, int *itemset, int k);
+};
+
+#endif